@@ -59,6 +59,23 @@ def get_maya_version(build_dir):
                 tokens = line.split()
                 return tokens[-1][:4]
 
+def get_appleseed_schema(build_dir):
+    appleseed_include_dir = None
+
+    # Find the appleseed include dir from CMake's cache.
+    f = open(os.path.join(build_dir, 'CMakeCache.txt'), 'r')
+    lines = f.readlines()
+    f.close()
+
+    token = 'APPLESEED_INCLUDE_DIR:PATH='
+    for line in lines:
+        if line.startswith(token):
+            appleseed_include_dir = line.split('=')[1].strip()
+            break
+
+    # The schemas are installed next to the include dir.
+    return os.path.join(appleseed_include_dir, '..', 'schemas', 'project.xsd')
+
 def copy_plugins(args, maya_version):
     if platform.system().lower() in ['linux']:
         plugin_ext = '.so'
@@ -78,6 +95,30 @@ def copy_plugins(args, maya_version):
         plugins_dir
     )
 
+def copy_binaries(args):
+    if platform.system().lower() in ['windows']:
+        exe_ext = '.exe'
+    else:
+        exe_ext = ''
+
+    bin_dir = os.path.join(args.directory, 'bin')
+    if not os.path.exists(bin_dir):
+        os.makedirs(bin_dir)
+
+    print 'Copying appleseedMayaRender'
+    shutil.copy(
+        os.path.join(args.build_dir, 'src', 'appleseedmayarender', 'appleseedMayaRender' + exe_ext),
+        bin_dir
+    )
+
+def copy_schemas(args):
+    schemas_dir = os.path.join(args.directory, 'schemas')
+    if not os.path.exists(schemas_dir):
+        os.makedirs(schemas_dir)
+
+    print 'Copying appleseed project schema'
+    shutil.copy(get_appleseed_schema(args.build_dir), schemas_dir)
+
 def main():
     parser = argparse.ArgumentParser(description='Deploy Maya plugin')
 
@@ -114,5 +155,11 @@ def main():
     print 'Copying plugins...'
     copy_plugins(args, maya_version)
 
+    print 'Copying binaries...'
+    copy_binaries(args)
+
+    print 'Copying schemas...'
+    copy_schemas(args)
+
 if __name__ == '__main__':
     main()
@@ -112,6 +112,22 @@ class AEappleseedNodeTemplate(pm.ui.AETemplate):
             self.addControl('asSmoothTangents', label='Smooth Tangents')
             self.endLayout()
 
+            self.beginLayout('Motion Blur', collapse=1)
+            self.addControl('asTransformSamples', label='Transform Samples')
+            self.addControl('asDeformSamples', label='Deformation Samples')
+            self.addSeparator()
+            self.addControl('asVelocityBlur', label='Velocity Blur')
+            self.addControl('asVelocityColorSet', label='Velocity Color Set')
+            self.addControl('asVelocityScale', label='Velocity Scale')
+            self.endLayout()
+
+            self.endLayout()
+
+        elif self.thisNode.type() == 'nurbsCurve':
+            self.beginLayout('Appleseed', collapse=1)
+            self.addControl('asRenderCurve', label='Render Curve')
+            self.addControl('asCurveWidth' , label='Curve Width')
+            self.__buildVisibilitySection()
             self.endLayout()
 
         elif self.thisNode.type() == 'shadingEngine':
@@ -120,5 +136,10 @@ class AEappleseedNodeTemplate(pm.ui.AETemplate):
             self.addControl('asShadingSamples', label='Shading Samples')
             self.endLayout()
 
+        elif self.thisNode.type() == 'transform':
+            self.beginLayout('Appleseed', collapse=1)
+            self.addControl('asExportAsAssembly', label='Export As Assembly')
+            self.endLayout()
+
 def appleseedAETemplateCallback(nodeName):
     AEappleseedNodeTemplate(nodeName)
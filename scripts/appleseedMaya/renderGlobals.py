@@ -250,6 +250,18 @@ class AppleseedRenderGlobalsMainTab(object):
         self.__uis["glossyBounces"].setEnable(value)
         self.__uis["diffuseBounces"].setEnable(value)
 
+    def __pixelSamplerChanged(self, value):
+        adaptive = mc.getAttr("appleseedRenderGlobals.pixelSampler") == 1
+        self.__uis["samples"].setEnable(not adaptive)
+        self.__uis["minPixelSamples"].setEnable(adaptive)
+        self.__uis["maxPixelSamples"].setEnable(adaptive)
+        self.__uis["noiseThreshold"].setEnable(adaptive)
+
+    def __progressiveRenderChanged(self, value):
+        self.__uis["timeLimit"].setEnable(value)
+        self.__uis["progressiveMaxSamples"].setEnable(value)
+        self.__uis["convergenceThreshold"].setEnable(value)
+
     def __motionBlurChanged(self, value):
         self.__uis["mbCameraSamples"].setEnable(value)
         self.__uis["mbTransformSamples"].setEnable(value)
@@ -324,9 +336,28 @@ class AppleseedRenderGlobalsMainTab(object):
             with pm.columnLayout("appleseedColumnLayout", adjustableColumn=True, width=columnWidth):
                 with pm.frameLayout(label="Sampling", collapsable=True, collapse=False):
                     with pm.columnLayout("appleseedColumnLayout", adjustableColumn=True, width=columnWidth):
+                        attr = pm.Attribute("appleseedRenderGlobals.pixelSampler")
+                        menuItems = [(i, v) for i, v in enumerate(attr.getEnums().keys())]
                         self.__addControl(
-                            ui=pm.intFieldGrp(label="Pixel Samples", numberOfFields = 1),
+                            ui=pm.attrEnumOptionMenuGrp(
+                                label="Pixel Sampler",
+                                enumeratedItem=menuItems,
+                                changeCommand=self.__pixelSamplerChanged),
+                            attrName="pixelSampler")
+
+                        adaptive = mc.getAttr("appleseedRenderGlobals.pixelSampler") == 1
+                        self.__addControl(
+                            ui=pm.intFieldGrp(label="Pixel Samples", numberOfFields = 1, enable=not adaptive),
                             attrName="samples")
+                        self.__addControl(
+                            ui=pm.intFieldGrp(label="Min Samples", numberOfFields = 1, enable=adaptive),
+                            attrName="minPixelSamples")
+                        self.__addControl(
+                            ui=pm.intFieldGrp(label="Max Samples", numberOfFields = 1, enable=adaptive),
+                            attrName="maxPixelSamples")
+                        self.__addControl(
+                            ui=pm.floatFieldGrp(label="Noise Threshold", numberOfFields = 1, enable=adaptive),
+                            attrName="noiseThreshold")
                         self.__addControl(
                             ui=pm.intFieldGrp(label="Render Passes", numberOfFields = 1),
                             attrName="passes")
@@ -334,6 +365,23 @@ class AppleseedRenderGlobalsMainTab(object):
                             ui=pm.intFieldGrp(label="Tile Size", numberOfFields = 1),
                             attrName="tileSize")
 
+                with pm.frameLayout(label="Progressive Render", collapsable=True, collapse=True):
+                    with pm.columnLayout("appleseedColumnLayout", adjustableColumn=True, width=columnWidth):
+                        self.__addControl(
+                            ui=pm.checkBoxGrp(label="Progressive Render", changeCommand=self.__progressiveRenderChanged),
+                            attrName="progressiveRender")
+
+                        enableProgressive = mc.getAttr("appleseedRenderGlobals.progressiveRender")
+                        self.__addControl(
+                            ui=pm.floatFieldGrp(label="Time Limit (minutes)", numberOfFields = 1, enable=enableProgressive),
+                            attrName="timeLimit")
+                        self.__addControl(
+                            ui=pm.intFieldGrp(label="Max Samples", numberOfFields = 1, enable=enableProgressive),
+                            attrName="progressiveMaxSamples")
+                        self.__addControl(
+                            ui=pm.floatFieldGrp(label="Convergence Threshold", numberOfFields = 1, enable=enableProgressive),
+                            attrName="convergenceThreshold")
+
                 with pm.frameLayout(label="Shading", collapsable=True, collapse=False):
                     with pm.columnLayout("appleseedColumnLayout", adjustableColumn=True, width=columnWidth):
                         attr = pm.Attribute("appleseedRenderGlobals.diagnostics")
@@ -426,6 +474,15 @@ class AppleseedRenderGlobalsMainTab(object):
                         self.__addControl(
                             ui=pm.intFieldGrp(label="Threads", numberOfFields = 1),
                             attrName="threads")
+                        self.__addControl(
+                            ui=pm.checkBoxGrp(label="Convert Textures to .tx"),
+                            attrName="convertTextures")
+                        self.__addControl(
+                            ui=pm.floatFieldGrp(label="Checkpoint Interval (minutes)", numberOfFields = 1),
+                            attrName="checkpointInterval")
+                        self.__addControl(
+                            ui=pm.checkBoxGrp(label="Render in Separate Process"),
+                            attrName="renderInSeparateProcess")
 
         pm.setUITemplate("renderGlobalsTemplate", popTemplate=True)
         pm.setUITemplate("attributeEditorTemplate", popTemplate=True)
@@ -43,7 +43,9 @@ def translatorOptions(parent, action, initialSettings, resultCallback):
         "exportAnim"   : False,
         "startFrame"   : 1,
         "endFrame"     : 100,
-        "stepFrame"    : 1
+        "stepFrame"    : 1,
+        "deltaSequence": False,
+        "packProject"  : False
     }
 
     createGlobalNodes()
@@ -86,6 +88,13 @@ def translatorOptions(parent, action, initialSettings, resultCallback):
 
             mc.menuItem(label=camera)
 
+        mc.checkBoxGrp(
+            "as_exportOpts_packProject",
+            numberOfCheckBoxes=1,
+            label=" ",
+            label1="Packed Project (.appleseedz)",
+            value1=defaults["packProject"])
+
         mc.separator(style="single")
 
         def exportAnimChanged(value):
@@ -104,6 +113,11 @@ def translatorOptions(parent, action, initialSettings, resultCallback):
                 edit=True,
                 enable=value)
 
+            mc.checkBoxGrp(
+                "as_exportOpts_deltaSequence",
+                edit=True,
+                enable=value)
+
         exportAnim = defaults["exportAnim"]
         mc.checkBoxGrp(
             "as_exportOpts_exportAnim",
@@ -140,6 +154,14 @@ def translatorOptions(parent, action, initialSettings, resultCallback):
             enable=exportAnim,
             value=defaults["stepFrame"])
 
+        mc.checkBoxGrp(
+            "as_exportOpts_deltaSequence",
+            numberOfCheckBoxes=1,
+            label=" ",
+            label1="Export Static Objects Once",
+            enable=exportAnim,
+            value1=defaults["deltaSequence"])
+
     elif action == "query":
         options = ""
 
@@ -163,6 +185,10 @@ def translatorOptions(parent, action, initialSettings, resultCallback):
         if value:
             options +="activeCamera=" + value + ";"
 
+        value = mc.checkBoxGrp("as_exportOpts_packProject", query=True, value1=True)
+        if value:
+            options += "packProject=true;"
+
         exportAnim = mc.checkBoxGrp("as_exportOpts_exportAnim", query=True, value1=True)
         if exportAnim:
             options += "exportAnim=true;"
@@ -176,6 +202,10 @@ def translatorOptions(parent, action, initialSettings, resultCallback):
             value = mc.intSliderGrp("as_exportOpts_stepFrame", query=True, value=True)
             options += "stepFrame=" + str(value) + ";"
 
+            value = mc.checkBoxGrp("as_exportOpts_deltaSequence", query=True, value1=True)
+            if value:
+                options += "deltaSequence=true;"
+
         logger.debug("calling translator callback, options = %s" % options)
         mel.eval('%s "%s"' % (resultCallback, options))
 
@@ -30,6 +30,12 @@
 #include "appleseedmaya/appleseedsession.h"
 
 // Standard headers.
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <set>
+#include <string>
 #include <vector>
 
 // Boost headers.
@@ -43,13 +49,21 @@
 
 // Maya headers.
 #include <maya/MAnimControl.h>
+#include <maya/MCallbackIdArray.h>
 #include <maya/MCommonRenderSettingsData.h>
+#include <maya/MDagMessage.h>
 #include <maya/MDagPath.h>
+#include <maya/MDagPathArray.h>
+#include <maya/MDGMessage.h>
+#include <maya/MFnAttribute.h>
 #include <maya/MFnDagNode.h>
 #include <maya/MFnDependencyNode.h>
 #include <maya/MFnRenderLayer.h>
 #include <maya/MGlobal.h>
 #include <maya/MItDag.h>
+#include <maya/MMessage.h>
+#include <maya/MNodeMessage.h>
+#include <maya/MSceneMessage.h>
 #include <maya/MSelectionList.h>
 #include <maya/MObject.h>
 #include <maya/MObjectArray.h>
@@ -57,6 +71,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/scalar.h"
+#include "foundation/platform/types.h"
 #include "foundation/platform/timers.h"
 #include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/iostreamop.h"
@@ -64,6 +79,7 @@
 #include "foundation/utility/searchpaths.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
+#include "foundation/utility/zip.h"
 
 // appleseed.renderer headers.
 #include "renderer/api/environment.h"
@@ -78,6 +94,7 @@
 #include "appleseedmaya/attributeutils.h"
 #include "appleseedmaya/exceptions.h"
 #include "appleseedmaya/exporters/alphamapexporter.h"
+#include "appleseedmaya/exporters/assemblyexporter.h"
 #include "appleseedmaya/exporters/dagnodeexporter.h"
 #include "appleseedmaya/exporters/exporterfactory.h"
 #include "appleseedmaya/exporters/shadingengineexporter.h"
@@ -85,9 +102,14 @@
 #include "appleseedmaya/exporters/shapeexporter.h"
 #include "appleseedmaya/idlejobqueue.h"
 #include "appleseedmaya/logger.h"
+#include "appleseedmaya/rendercheckpoint.h"
 #include "appleseedmaya/renderercontroller.h"
 #include "appleseedmaya/renderglobalsnode.h"
+#include "appleseedmaya/renderprocess.h"
 #include "appleseedmaya/renderviewtilecallback.h"
+#include "appleseedmaya/textureconverter.h"
+#include "appleseedmaya/threadbudget.h"
+#include "appleseedmaya/transformcache.h"
 
 namespace bfs = boost::filesystem;
 namespace asf = foundation;
@@ -110,6 +132,8 @@ Options::Options()
   , m_firstFrame(1)
   , m_lastFrame(1)
   , m_frameStep(1)
+  , m_deltaSequence(false)
+  , m_packProject(false)
 {
 }
 
@@ -182,6 +206,10 @@ Services::~Services() {}
 namespace
 {
 
+// Return the paths to the appleseedMayaRender executable and to the project schema.
+MString renderProcessExecutable();
+MString renderProcessSchema();
+
 struct ScopedEndSession
 {
     ~ScopedEndSession()
@@ -190,6 +218,124 @@ struct ScopedEndSession
     }
 };
 
+struct ScopedTextureConversion
+{
+    ScopedTextureConversion()
+      : m_ended(false)
+    {
+    }
+
+    // Only reached without calling end() when the export is unwinding,
+    // after an abort or an error. Don't wait for the queued conversions then.
+    ~ScopedTextureConversion()
+    {
+        if (!m_ended)
+            TextureConverter::cancel();
+    }
+
+    void end()
+    {
+        TextureConverter::end();
+        m_ended = true;
+    }
+
+    bool m_ended;
+};
+
+class ScopedProgress
+  : public NonCopyable
+{
+  public:
+    explicit ScopedProgress(const ComputationPtr& computation)
+      : m_computation(computation)
+    {
+    }
+
+    ~ScopedProgress()
+    {
+        if (m_computation)
+            m_computation->endProgress();
+    }
+
+    void begin(const MString& status, const size_t maxProgress)
+    {
+        if (m_computation)
+            m_computation->beginProgress(status, static_cast<int>(maxProgress));
+    }
+
+    void advance()
+    {
+        if (m_computation)
+            m_computation->advanceProgress();
+    }
+
+  private:
+    ComputationPtr m_computation;
+};
+
+// Reports progressive frame updates to the renderer controller in batch renders.
+class ConvergenceTileCallback
+  : public asr::ITileCallback
+{
+  public:
+    explicit ConvergenceTileCallback(RendererController& rendererController)
+      : m_rendererController(rendererController)
+    {
+    }
+
+    virtual void release()
+    {
+        delete this;
+    }
+
+    virtual void pre_render(
+        const size_t        x,
+        const size_t        y,
+        const size_t        width,
+        const size_t        height)
+    {
+    }
+
+    virtual void post_render_tile(
+        const asr::Frame*   frame,
+        const size_t        tile_x,
+        const size_t        tile_y)
+    {
+    }
+
+    virtual void post_render(
+        const asr::Frame*   frame)
+    {
+        m_rendererController.frameUpdated(*frame);
+    }
+
+  private:
+    RendererController& m_rendererController;
+};
+
+class ConvergenceTileCallbackFactory
+  : public asr::ITileCallbackFactory
+{
+  public:
+    explicit ConvergenceTileCallbackFactory(RendererController& rendererController)
+      : m_rendererController(rendererController)
+    {
+    }
+
+    virtual void release()
+    {
+        delete this;
+    }
+
+    virtual asr::ITileCallback* create()
+    {
+        return new ConvergenceTileCallback(m_rendererController);
+    }
+
+  private:
+    RendererController& m_rendererController;
+};
+
 struct SessionImpl
   : NonCopyable
 {
@@ -241,6 +387,7 @@ struct SessionImpl
                     object,
                     outputPlug,
                     *m_self.mainAssembly(),
+                    m_self.m_nameAllocator,
                     m_self.m_sessionMode));
             m_self.m_shadingNetworkExporters[context][depNodeFn.name()] = exporter;
             return exporter;
@@ -281,6 +428,7 @@ struct SessionImpl
       , m_options(options)
       , m_services(*this)
       , m_computation(computation)
+      , m_sceneChanged(false)
     {
         createProject(options.m_colorspace);
     }
@@ -295,9 +443,26 @@ struct SessionImpl
       , m_services(*this)
       , m_computation(computation)
       , m_fileName(fileName)
+      , m_sceneChanged(false)
     {
         m_projectPath = bfs::path(fileName.asChar()).parent_path();
 
+        if (options.m_packProject)
+        {
+            // Stage the geometry and textures in a local temporary directory.
+            // They are copied to the packed project when it is written.
+            boost::system::error_code error;
+            m_projectPath = bfs::temp_directory_path(error) / bfs::unique_path("appleseedmaya-%%%%-%%%%-%%%%");
+            if (error || !bfs::create_directories(m_projectPath, error))
+            {
+                RENDERER_LOG_ERROR("Couldn't create a staging directory for the packed project. Aborting");
+                throw AppleseedSessionExportError();
+            }
+
+            m_stagingPath = m_projectPath;
+            m_fileName = bfs::path(fileName.asChar()).replace_extension(".appleseedz").string().c_str();
+        }
+
         // Create a dir to store the geom files if it does not exist yet.
         boost::filesystem::path geomPath = m_projectPath / "_geometry";
         if (!boost::filesystem::exists(geomPath))
@@ -319,6 +484,15 @@ struct SessionImpl
     ~SessionImpl()
     {
         abortRender();
+
+        if (!m_stagingPath.empty())
+        {
+            boost::system::error_code error;
+            bfs::remove_all(m_stagingPath, error);
+        }
+
+        if (m_callbackIds.length() != 0)
+            MMessage::removeCallbacks(m_callbackIds);
     }
 
     void createProject(const char* colorspace)
@@ -327,30 +501,7 @@ struct SessionImpl
 
         m_project = asr::ProjectFactory::create("project");
         m_project->add_default_configurations();
-
-        // Insert some config params needed by the interactive renderer.
-        asr::Configuration *cfg = m_project->configurations().get_by_name("interactive");
-        asr::ParamArray *cfg_params = &cfg->get_parameters();
-        cfg_params->insert("sample_renderer", "generic");
-        cfg_params->insert("sample_generator", "generic");
-        cfg_params->insert("tile_renderer", "generic");
-        cfg_params->insert("frame_renderer", "progressive");
-        cfg_params->insert("lighting_engine", "pt");
-        cfg_params->insert("pixel_renderer", "uniform");
-        cfg_params->insert("sampling_mode", "qmc");
-        cfg_params->insert_path("progressive_frame_renderer.max_fps", "5");
-
-        // Insert some config params needed by the final renderer.
-        cfg = m_project->configurations().get_by_name("final");
-        cfg_params = &cfg->get_parameters();
-        cfg_params->insert("sample_renderer", "generic");
-        cfg_params->insert("sample_generator", "generic");
-        cfg_params->insert("tile_renderer", "generic");
-        cfg_params->insert("frame_renderer", "generic");
-        cfg_params->insert("lighting_engine", "pt");
-        cfg_params->insert("pixel_renderer", "uniform");
-        cfg_params->insert("sampling_mode", "qmc");
-        cfg_params->insert_path("uniform_pixel_renderer.samples", "16");
+        initializeConfigurations();
 
         // Create some basic project entities.
 
@@ -381,6 +532,35 @@ struct SessionImpl
         m_project->get_scene()->assembly_instances().insert(assemblyInstance);
     }
 
+    void initializeConfigurations()
+    {
+        // Insert some config params needed by the interactive renderer.
+        asr::Configuration *cfg = m_project->configurations().get_by_name("interactive");
+        asr::ParamArray *cfg_params = &cfg->get_parameters();
+        cfg_params->clear();
+        cfg_params->insert("sample_renderer", "generic");
+        cfg_params->insert("sample_generator", "generic");
+        cfg_params->insert("tile_renderer", "generic");
+        cfg_params->insert("frame_renderer", "progressive");
+        cfg_params->insert("lighting_engine", "pt");
+        cfg_params->insert("pixel_renderer", "uniform");
+        cfg_params->insert("sampling_mode", "qmc");
+        cfg_params->insert_path("progressive_frame_renderer.max_fps", "5");
+
+        // Insert some config params needed by the final renderer.
+        cfg = m_project->configurations().get_by_name("final");
+        cfg_params = &cfg->get_parameters();
+        cfg_params->clear();
+        cfg_params->insert("sample_renderer", "generic");
+        cfg_params->insert("sample_generator", "generic");
+        cfg_params->insert("tile_renderer", "generic");
+        cfg_params->insert("frame_renderer", "generic");
+        cfg_params->insert("lighting_engine", "pt");
+        cfg_params->insert("pixel_renderer", "uniform");
+        cfg_params->insert("sampling_mode", "qmc");
+        cfg_params->insert_path("uniform_pixel_renderer.samples", "16");
+    }
+
     void exportProject()
     {
         exportDefaultRenderGlobals();
@@ -393,7 +573,29 @@ struct SessionImpl
         else
             motionBlurTimes.initializeToCurrentFrame();
 
+        // Convert textures to tiled and mipmapped files in the background.
+        bool convertTextures = false;
+        AttributeUtils::get(globalsNode, "convertTextures", convertTextures);
+        if (convertTextures && m_sessionMode != AppleseedSession::ProgressiveRenderSession)
+        {
+            // Exported projects reference their textures relative to the project root,
+            // so that they can be moved and packed.
+            if (m_sessionMode == AppleseedSession::ExportSession)
+            {
+                TextureConverter::begin(
+                    (m_projectPath / "_textures").string().c_str(),
+                    "_textures");
+            }
+            else
+                TextureConverter::begin(TextureConverter::defaultCacheDirectory());
+        }
+
+        ScopedTextureConversion textureConversion;
         exportScene(motionBlurTimes);
+        textureConversion.end();
+
+        if (m_staticSceneFileName.length() != 0)
+            referenceStaticScene();
 
         // Set the shutter open and close times in all cameras.
         asr::CameraContainer& cameras = m_project->get_scene()->cameras();
@@ -460,6 +662,11 @@ struct SessionImpl
             }
         }
 
+        createFrame(params, globalsNode);
+    }
+
+    void createFrame(asr::ParamArray params, const MObject& globalsNode)
+    {
         // Set the resolution.
         params.insert("resolution", asf::Vector2i(m_options.m_width, m_options.m_height));
 
@@ -506,13 +713,58 @@ struct SessionImpl
 
         checkUserAborted();
 
+        // Collect per object motion blur times.
+        RENDERER_LOG_DEBUG("Collecting dag motion blur times");
+        DagMotionBlurTimesMap dagMotionBlurTimes;
+        for(DagExporterMap::const_iterator it = m_dagExporters.begin(), e = m_dagExporters.end(); it != e; ++it)
+        {
+            AppleseedSession::MotionBlurTimes times(motionBlurTimes);
+            it->second->collectMotionBlurSteps(times);
+
+            if (times.m_transformTimes != motionBlurTimes.m_transformTimes ||
+                times.m_deformTimes != motionBlurTimes.m_deformTimes)
+            {
+                times.mergeTimes();
+                dagMotionBlurTimes[it->first] = times;
+            }
+        }
+
+        ScopedProgress progress(m_computation);
+
         RENDERER_LOG_DEBUG("Creating dag entities");
+        progress.begin("Creating entities", m_dagExporters.size());
         for(DagExporterMap::const_iterator it = m_dagExporters.begin(), e = m_dagExporters.end(); it != e; ++it)
-            it->second->createEntities(m_options, motionBlurTimes);
+        {
+            it->second->createEntities(
+                m_options,
+                dagNodeMotionBlurTimes(it->first, motionBlurTimes, dagMotionBlurTimes));
+            progress.advance();
+        }
+
+        // Collect the times where the scene needs to be evaluated.
+        // Deformation times are only needed by shapes that can't build
+        // their deformation keys from the first one.
+        std::set<float> evaluationTimes(motionBlurTimes.m_cameraTimes);
+        for(DagExporterMap::const_iterator it = m_dagExporters.begin(), e = m_dagExporters.end(); it != e; ++it)
+        {
+            if (!it->second->supportsMotionBlur())
+                continue;
+
+            const AppleseedSession::MotionBlurTimes& times =
+                dagNodeMotionBlurTimes(it->first, motionBlurTimes, dagMotionBlurTimes);
+
+            evaluationTimes.insert(times.m_transformTimes.begin(), times.m_transformTimes.end());
+
+            if (it->second->needsShapeMotionSteps())
+                evaluationTimes.insert(times.m_deformTimes.begin(), times.m_deformTimes.end());
+            else if (!times.m_deformTimes.empty())
+                evaluationTimes.insert(*times.m_deformTimes.begin());
+        }
 
         RENDERER_LOG_DEBUG("Exporting motion steps");
-        std::set<float>::const_iterator frameIt(motionBlurTimes.m_allTimes.begin());
-        std::set<float>::const_iterator frameEnd(motionBlurTimes.m_allTimes.end());
+        progress.begin("Exporting motion steps", evaluationTimes.size() * m_dagExporters.size());
+        std::set<float>::const_iterator frameIt(evaluationTimes.begin());
+        std::set<float>::const_iterator frameEnd(evaluationTimes.end());
         for (; frameIt != frameEnd; ++frameIt)
         {
             const float now = static_cast<float>(MAnimControl::currentTime().value());
@@ -525,24 +777,32 @@ struct SessionImpl
 
             const float frame = motionBlurTimes.normalizedFrame(*frameIt);
 
+            // World transforms are only valid for the current time.
+            m_transformCache.clear();
+
             for(DagExporterMap::const_iterator it = m_dagExporters.begin(), e = m_dagExporters.end(); it != e; ++it)
             {
                 if (it->second->supportsMotionBlur())
                 {
-                    if (motionBlurTimes.m_cameraTimes.count(*frameIt))
-                        it->second->exportCameraMotionStep(frame);
+                    const AppleseedSession::MotionBlurTimes& times =
+                        dagNodeMotionBlurTimes(it->first, motionBlurTimes, dagMotionBlurTimes);
+
+                    if (times.m_cameraTimes.count(*frameIt))
+                        it->second->exportCameraMotionStep(frame, m_transformCache);
 
-                    if (motionBlurTimes.m_transformTimes.count(*frameIt))
-                        it->second->exportTransformMotionStep(frame);
+                    if (times.m_transformTimes.count(*frameIt))
+                        it->second->exportTransformMotionStep(frame, m_transformCache);
 
-                    if (motionBlurTimes.m_deformTimes.count(*frameIt))
+                    if (times.m_deformTimes.count(*frameIt))
                         it->second->exportShapeMotionStep(frame);
                 }
 
-                checkUserAborted();
+                progress.advance();
             }
         }
 
+        m_transformCache.clear();
+
         // Handle auto-instancing.
         if (m_sessionMode != AppleseedSession::ProgressiveRenderSession)
         {
@@ -574,8 +834,12 @@ struct SessionImpl
         checkUserAborted();
 
         RENDERER_LOG_DEBUG("Flushing dag entities");
+        progress.begin("Flushing entities", m_dagExporters.size());
         for(DagExporterMap::const_iterator it = m_dagExporters.begin(), e = m_dagExporters.end(); it != e; ++it)
+        {
             it->second->flushEntities();
+            progress.advance();
+        }
     }
 
     void exportDefaultRenderGlobals()
@@ -613,20 +877,14 @@ struct SessionImpl
             MSelectionList sel;
             status = MGlobal::getActiveSelectionList(sel);
 
-            MDagPath rootPath, path;
-            MItDag it(MItDag::kBreadthFirst);
-
+            MDagPath rootPath;
             for(int i = 0, e = sel.length(); i < e; ++i)
             {
                 status = sel.getDagPath(i, rootPath);
                 if (status)
                 {
-                    for(it.reset(rootPath); !it.isDone(); it.next())
-                    {
-                        status = it.getPath(path);
-                        if (status)
-                            createDagNodeExporter(path);
-                    }
+                    const bool isRenderable = DagNodeExporter::areObjectAndParentsRenderable(rootPath);
+                    createDagPathExporters(rootPath, isRenderable, 0);
                 }
             }
         }
@@ -634,12 +892,9 @@ struct SessionImpl
         {
             // Create exporters for all the dag nodes in the scene.
             RENDERER_LOG_DEBUG("Creating dag node exporters");
-            MDagPath path;
-            for(MItDag it(MItDag::kDepthFirst); !it.isDone(); it.next())
-            {
-                it.getPath(path);
-                createDagNodeExporter(path);
-            }
+            MDagPath worldPath;
+            MDagPath::getAPathTo(MItDag().root(), worldPath);
+            createDagNodeExporters(worldPath, true, 0);
         }
 
         createExtraExporters();
@@ -652,6 +907,10 @@ struct SessionImpl
         for(DagExporterMap::const_iterator it = m_dagExporters.begin(), e = m_dagExporters.end(); it != e; ++it)
             it->second->createExporters(m_services);
 
+        // Static shapes exported by a previous frame still need their materials.
+        for(DagExporterMap::const_iterator it = m_staticDagExporters.begin(), e = m_staticDagExporters.end(); it != e; ++it)
+            it->second->createExporters(m_services);
+
         checkUserAborted();
 
         // Create shading engine extra exporters.
@@ -660,19 +919,167 @@ struct SessionImpl
             it->second->createExporters(m_services);
     }
 
-    void createDagNodeExporter(const MDagPath& path)
+    // Visit the children of a dag path, propagating the renderability
+    // of the parents, so that each node is only checked once.
+    void createDagNodeExporters(
+        const MDagPath&     parentPath,
+        const bool          isParentRenderable,
+        AssemblyExporter*   parentAssembly)
     {
-        checkUserAborted();
+        for (unsigned int i = 0, e = parentPath.childCount(); i < e; ++i)
+        {
+            MDagPath path(parentPath);
+            path.push(parentPath.child(i));
+
+            const bool isRenderable =
+                isParentRenderable && DagNodeExporter::isObjectRenderable(path);
+
+            // Remember where hidden subtrees start, to watch them for changes.
+            if (isParentRenderable && !isRenderable)
+                m_hiddenDagPaths.append(path);
+
+            createDagPathExporters(path, isRenderable, parentAssembly);
+        }
+    }
+
+    // Create the exporters of a dag path and its children.
+    void createDagPathExporters(
+        const MDagPath&     path,
+        const bool          isRenderable,
+        AssemblyExporter*   parentAssembly)
+    {
+        // Groups exported as assemblies collect the entities of their children.
+        // Progressive renders keep everything in the main assembly.
+        if (isRenderable &&
+            m_sessionMode != AppleseedSession::ProgressiveRenderSession &&
+            AssemblyExporter::isAssembly(path))
+        {
+            AssemblyExporter* assembly = createAssemblyExporter(path, parentAssembly);
+
+            // Instances of an already exported group have nothing else to export.
+            if (assembly)
+                createDagNodeExporters(path, isRenderable, assembly);
 
-        if (m_dagExporters.count(path.fullPathName()) != 0)
             return;
+        }
+
+        createDagNodeExporter(path, isRenderable, parentAssembly);
+        createDagNodeExporters(path, isRenderable, parentAssembly);
+    }
+
+    // Return the key used to find the master of an instanced dag node.
+    // Masters are only shared inside an assembly, as appleseed
+    // does not look for entities in child assemblies.
+    static MString instanceMasterKey(const MDagPath& path, const AssemblyExporter* parentAssembly)
+    {
+        MDagPath firstPath;
+        MDagPath::getAPathTo(path.node(), firstPath);
+
+        MString key = firstPath.fullPathName();
+        if (parentAssembly)
+            key = parentAssembly->assemblyName() + MString("@") + key;
 
-        MFnDagNode dagNodeFn(path);
+        return key;
+    }
+
+    AssemblyExporter* createAssemblyExporter(const MDagPath& path, AssemblyExporter* parentAssembly)
+    {
+        checkUserAborted();
+
+        const MString pathName = path.fullPathName();
+
+        MString instanceKey;
+        if (path.isInstanced())
+        {
+            instanceKey = instanceMasterKey(path, parentAssembly);
+
+            AssemblyMasterMap::const_iterator it = m_assemblyMasters.find(instanceKey);
+            if (it != m_assemblyMasters.end())
+            {
+                DagNodeExporterPtr exporter(
+                    AssemblyExporter::createInstance(
+                        path,
+                        *m_project,
+                        m_sessionMode,
+                        *it->second));
+
+                if (parentAssembly)
+                    parentAssembly->addExporter(*exporter);
+
+                m_dagExporters[pathName] = exporter;
+                RENDERER_LOG_DEBUG(
+                    "Created assembly instance exporter for node %s",
+                    pathName.asChar());
+
+                return 0;
+            }
+        }
+
+        AssemblyExporterPtr exporter(
+            AssemblyExporter::create(path, *m_project, m_sessionMode));
+
+        if (parentAssembly)
+            parentAssembly->addExporter(*exporter);
+
+        m_dagExporters[pathName] = exporter;
+        RENDERER_LOG_DEBUG(
+            "Created assembly exporter for node %s",
+            pathName.asChar());
+
+        if (path.isInstanced())
+            m_assemblyMasters[instanceKey] = exporter;
+
+        return exporter.get();
+    }
+
+    void createDagNodeExporter(
+        const MDagPath&     path,
+        const bool          isRenderable,
+        AssemblyExporter*   parentAssembly)
+    {
+        checkUserAborted();
 
         // Avoid warnings about missing exporter for transform nodes.
-        if (dagNodeFn.typeName() == "transform")
+        if (path.hasFn(MFn::kTransform))
+            return;
+
+        const MString pathName = path.fullPathName();
+        if (m_dagExporters.count(pathName) != 0)
             return;
 
+        // Instanced shapes are exported once; the other dag paths
+        // to the same shape only reference the master exporter,
+        // unless they can not share its geometry.
+        MString instanceKey;
+        if (path.isInstanced() && isRenderable)
+        {
+            instanceKey = instanceMasterKey(path, parentAssembly);
+
+            InstanceMasterMap::const_iterator it = m_instanceMasters.find(instanceKey);
+            if (it != m_instanceMasters.end() && it->second->canInstance(path))
+            {
+                DagNodeExporterPtr exporter(
+                    NodeExporterFactory::createInstanceExporter(
+                        path,
+                        *m_project,
+                        m_sessionMode,
+                        *it->second));
+
+                if (exporter)
+                {
+                    if (parentAssembly)
+                        parentAssembly->addExporter(*exporter);
+
+                    m_dagExporters[pathName] = exporter;
+                    RENDERER_LOG_DEBUG(
+                        "Created instance exporter for node %s",
+                        pathName.asChar());
+                }
+
+                return;
+            }
+        }
+
         DagNodeExporterPtr exporter;
 
         try
@@ -680,25 +1087,88 @@ struct SessionImpl
             exporter.reset(NodeExporterFactory::createDagNodeExporter(
                 path,
                 *m_project,
-                m_sessionMode));
+                m_sessionMode,
+                isRenderable));
         }
         catch (const NoExporterForNode&)
         {
-            RENDERER_LOG_WARNING(
-                "No dag exporter found for node type %s",
-                dagNodeFn.typeName().asChar());
+            if (isRenderable)
+            {
+                RENDERER_LOG_WARNING(
+                    "No dag exporter found for node type %s",
+                    MFnDependencyNode(path.node()).typeName().asChar());
+            }
             return;
         }
 
         if (exporter)
         {
-            m_dagExporters[path.fullPathName()] = exporter;
+            if (isRenderable && isStaticShape(path, parentAssembly, *exporter))
+            {
+                // Only the first frame of the sequence exports static shapes.
+                if (m_staticAssembly.get() == 0)
+                {
+                    m_staticDagExporters[pathName] = exporter;
+                    return;
+                }
+
+                exporter->setParentAssembly(*m_staticAssembly, MDagPath());
+            }
+            else if (parentAssembly)
+                parentAssembly->addExporter(*exporter);
+
+            m_dagExporters[pathName] = exporter;
             RENDERER_LOG_DEBUG(
                 "Created dag exporter for node %s",
-                dagNodeFn.name().asChar());
+                pathName.asChar());
+
+            if (path.isInstanced() && isRenderable)
+            {
+                ShapeExporterPtr shape = boost::dynamic_pointer_cast<ShapeExporter>(exporter);
+                if (shape && shape->supportsInstancing() && m_instanceMasters.count(instanceKey) == 0)
+                    m_instanceMasters[instanceKey] = shape;
+            }
         }
     }
 
+    // Return true if a shape does not change during the sequence and can be
+    // exported once to the static scene. Instanced shapes and shapes inside
+    // exported groups always stay in the projects of the frames.
+    bool isStaticShape(
+        const MDagPath&             path,
+        const AssemblyExporter*     parentAssembly,
+        const DagNodeExporter&      exporter) const
+    {
+        if (m_staticSceneFileName.length() == 0 || parentAssembly || path.isInstanced())
+            return false;
+
+        if (dynamic_cast<const ShapeExporter*>(&exporter) == 0)
+            return false;
+
+        return
+            !DagNodeExporter::isAnimated(path.node(), true) &&
+            !DagNodeExporter::isAnimated(path.transform(), true);
+    }
+
+    void referenceStaticScene()
+    {
+        // Static shapes are looked up by the frame projects through an archive
+        // assembly nested in the main assembly, so that they can still use
+        // the materials exported in the main assembly.
+        asf::auto_release_ptr<asr::Assembly> archive(
+            asr::ArchiveAssemblyFactory().create(
+                "static_scene",
+                asr::ParamArray().insert("filename", m_staticSceneFileName.asChar())));
+        mainAssembly()->assemblies().insert(archive);
+
+        asf::auto_release_ptr<asr::AssemblyInstance> archiveInstance(
+            asr::AssemblyInstanceFactory::create(
+                "static_scene_instance",
+                asr::ParamArray(),
+                "static_scene"));
+        mainAssembly()->assembly_instances().insert(archiveInstance);
+    }
+
     void convertObjectsToInstances()
     {
         for(DagExporterMap::const_iterator it = m_dagExporters.begin(), e = m_dagExporters.end(); it != e; ++it)
@@ -734,12 +1204,18 @@ struct SessionImpl
 
         // Create the master renderer.
         asr::Configuration *cfg = m_project->configurations().get_by_name("final");
-        const asr::ParamArray& params = cfg->get_parameters();
+        asr::ParamArray& params = cfg->get_parameters();
+        reserveRenderingThreads(params);
+        applyRenderLimits(params);
 
         m_tileCallbackFactory.reset(
             new RenderViewTileCallbackFactory(m_rendererController, m_computation));
         m_tileCallbackFactory->renderViewStart(*m_project->get_frame());
 
+        // Keep the renderer out of Maya if requested.
+        if (startRenderProcess())
+            return;
+
         m_renderer.reset(
             new asr::MasterRenderer(
                 *m_project,
@@ -752,23 +1228,77 @@ struct SessionImpl
         m_renderThread.swap(thread);
     }
 
-    void batchRender()
+    void batchRender(const MString& outputFileName)
     {
         // Reset the renderer controller.
         m_rendererController.set_status(asr::IRendererController::ContinueRendering);
 
         // Create the master renderer.
         asr::Configuration *cfg = m_project->configurations().get_by_name("final");
-        const asr::ParamArray& params = cfg->get_parameters();
+        asr::ParamArray& params = cfg->get_parameters();
+        reserveRenderingThreads(params);
+
+        // Convergence tests need the progressive frame updates.
+        if (applyRenderLimits(params))
+            m_batchTileCallbackFactory.reset(new ConvergenceTileCallbackFactory(m_rendererController));
+        else if (enableCheckpoints(params, outputFileName))
+        {
+            if (m_checkpoint->isComplete())
+            {
+                RENDERER_LOG_INFO("All tiles were restored from the render checkpoint");
+                m_checkpoint->restoreTiles(*m_project->get_frame());
+                return;
+            }
+
+            m_batchTileCallbackFactory.reset(m_checkpoint->createTileCallbackFactory());
+        }
 
         m_renderer.reset(
             new asr::MasterRenderer(
                 *m_project,
                 params,
                 &m_rendererController,
-                static_cast<asr::ITileCallbackFactory*>(0)));
+                m_batchTileCallbackFactory.get()));
 
         m_renderer->render();
+
+        if (m_checkpoint)
+            m_checkpoint->restoreTiles(*m_project->get_frame());
+    }
+
+    // Save the rendered tiles periodically, so that interrupted batch renders can resume.
+    bool enableCheckpoints(asr::ParamArray& params, const MString& outputFileName)
+    {
+        MObject globalsNode;
+        if (!getDependencyNodeByName("appleseedRenderGlobals", globalsNode))
+            return false;
+
+        float checkpointInterval = 0.0f;
+        AttributeUtils::get(globalsNode, "checkpointInterval", checkpointInterval);
+        if (checkpointInterval <= 0.0f)
+            return false;
+
+        // Only single pass, tile based renders have final tiles.
+        if (params.get_optional<std::string>("frame_renderer", "generic") != "generic" ||
+            params.get_path_optional<size_t>("generic_frame_renderer.passes", 1) != 1)
+        {
+            RENDERER_LOG_WARNING("Render checkpoints are only supported for single pass, non progressive renders");
+            return false;
+        }
+
+        // Render the tiles in scanline order, so that a resumed render
+        // only needs to render the rows after the first unfinished tile.
+        params.insert_path("generic_frame_renderer.tile_ordering", "linear");
+
+        m_checkpoint.reset(new RenderCheckpoint(outputFileName, checkpointInterval * 60.0));
+        m_checkpoint->resume(*m_project->get_frame());
+        return true;
+    }
+
+    void removeCheckpoint()
+    {
+        if (m_checkpoint)
+            m_checkpoint->remove();
     }
 
     void progressiveRender()
@@ -786,6 +1316,140 @@ struct SessionImpl
         */
     }
 
+    // Set the time, sample and convergence limits of progressive final renders.
+    // Returns true if the render stops when the image converges.
+    bool applyRenderLimits(asr::ParamArray& params)
+    {
+        m_rendererController.setTimeLimit(0.0);
+        m_rendererController.setConvergenceThreshold(0.0f);
+        params.remove_path("progressive_frame_renderer.max_samples");
+
+        MObject globalsNode;
+        if (!getDependencyNodeByName("appleseedRenderGlobals", globalsNode))
+            return false;
+
+        bool progressiveRender = false;
+        AttributeUtils::get(globalsNode, "progressiveRender", progressiveRender);
+        if (!progressiveRender)
+            return false;
+
+        float timeLimit = 0.0f;
+        if (AttributeUtils::get(globalsNode, "timeLimit", timeLimit))
+            m_rendererController.setTimeLimit(timeLimit * 60.0);
+
+        int maxSamples = 0;
+        if (AttributeUtils::get(globalsNode, "progressiveMaxSamples", maxSamples) && maxSamples > 0)
+        {
+            // appleseed limits the total number of samples in the frame.
+            const asf::AABB2u& cropWindow = m_project->get_frame()->get_crop_window();
+            const asf::uint64 numPixels =
+                static_cast<asf::uint64>(cropWindow.max.x - cropWindow.min.x + 1) *
+                static_cast<asf::uint64>(cropWindow.max.y - cropWindow.min.y + 1);
+            params.insert_path("progressive_frame_renderer.max_samples", numPixels * maxSamples);
+        }
+
+        float convergenceThreshold = 0.0f;
+        AttributeUtils::get(globalsNode, "convergenceThreshold", convergenceThreshold);
+        m_rendererController.setConvergenceThreshold(convergenceThreshold);
+        return convergenceThreshold > 0.0f;
+    }
+
+    void reserveRenderingThreads(asr::ParamArray& params)
+    {
+        // A value of 0 or auto means all the threads not used by other renders.
+        int requestedThreads = 0;
+        const std::string threads = params.get_optional<std::string>("rendering_threads", "auto");
+        if (threads != "auto")
+        {
+            try
+            {
+                requestedThreads = std::max(asf::from_string<int>(threads), 0);
+            }
+            catch (const asf::ExceptionStringConversionError&)
+            {
+                RENDERER_LOG_WARNING("Invalid rendering threads value %s, using auto", threads.c_str());
+            }
+        }
+
+        const size_t numThreads = m_renderingThreads.acquire(
+            ThreadBudget::HighPriority,
+            static_cast<size_t>(requestedThreads));
+        params.insert("rendering_threads", numThreads);
+    }
+
+    // Render in a separate process, streaming the tiles back to the render view.
+    bool startRenderProcess()
+    {
+        MObject globalsNode;
+        if (!getDependencyNodeByName("appleseedRenderGlobals", globalsNode))
+            return false;
+
+        bool separateProcess = false;
+        AttributeUtils::get(globalsNode, "renderInSeparateProcess", separateProcess);
+        if (!separateProcess)
+            return false;
+
+        // Write the project and its geometry to a temporary directory.
+        boost::system::error_code error;
+        m_renderProcessPath = bfs::temp_directory_path(error) / bfs::unique_path("appleseedmaya-%%%%-%%%%-%%%%");
+        if (error || !bfs::create_directories(m_renderProcessPath, error))
+        {
+            RENDERER_LOG_ERROR("Couldn't create a directory for the render process, rendering in Maya");
+            return false;
+        }
+
+        const bfs::path projectFileName = m_renderProcessPath / "render.appleseed";
+        if (!asr::ProjectFileWriter::write(
+                *m_project,
+                projectFileName.string().c_str(),
+                asr::ProjectFileWriter::OmitHandlingAssetFiles))
+        {
+            RENDERER_LOG_ERROR("Couldn't write the project for the render process, rendering in Maya");
+            removeRenderProcessFiles();
+            return false;
+        }
+
+        m_renderProcess.reset(
+            new RenderProcess(
+                m_rendererController,
+                *m_project->get_frame(),
+                m_tileCallbackFactory->create()));
+
+        if (!m_renderProcess->start(
+                renderProcessExecutable(),
+                projectFileName.string().c_str(),
+                renderProcessSchema(),
+                m_renderingThreads.numThreads()))
+        {
+            RENDERER_LOG_ERROR("Couldn't start the render process, rendering in Maya");
+            m_renderProcess.reset();
+            removeRenderProcessFiles();
+            return false;
+        }
+
+        boost::thread thread(&SessionImpl::renderProcessFunc, this);
+        m_renderThread.swap(thread);
+        return true;
+    }
+
+    void renderProcessFunc()
+    {
+        if (!m_renderProcess->wait())
+            RENDERER_LOG_WARNING("The render process did not complete the render");
+
+        IdleJobQueue::pushJob(&AppleseedSession::endSession);
+    }
+
+    void removeRenderProcessFiles()
+    {
+        if (!m_renderProcessPath.empty())
+        {
+            boost::system::error_code error;
+            bfs::remove_all(m_renderProcessPath, error);
+            m_renderProcessPath.clear();
+        }
+    }
+
     void renderFunc()
     {
         m_renderer->render();
@@ -795,19 +1459,319 @@ struct SessionImpl
     void abortRender()
     {
         m_rendererController.set_status(asr::IRendererController::AbortRendering);
+
+        if (m_renderProcess)
+            m_renderProcess->abort();
+
         if (m_renderThread.joinable())
             m_renderThread.join();
+
+        m_renderProcess.reset();
+        removeRenderProcessFiles();
+    }
+
+    // Watch the nodes used by the render, so that the project can be
+    // reused by the next render if nothing relevant changed in the scene.
+    void trackSceneChanges()
+    {
+        assert(m_sessionMode == AppleseedSession::FinalRenderSession);
+
+        MStatus status;
+
+        // Dag nodes. Watch the exported nodes and their parents, and the roots
+        // of hidden subtrees, as showing them changes the set of exported nodes.
+        // Nodes added, removed or reparented are caught by the callbacks below.
+        WatchedDagPathSet watchedPaths;
+        for(DagExporterMap::const_iterator it = m_dagExporters.begin(), e = m_dagExporters.end(); it != e; ++it)
+            watchDagPath(it->second->dagPath(), watchedPaths);
+
+        for(unsigned int i = 0, e = m_hiddenDagPaths.length(); i < e; ++i)
+            watchDagPath(m_hiddenDagPaths[i], watchedPaths);
+
+        // Shading nodes. Changes upstream of them are reported as dirty propagation.
+        MObject node;
+        for(ShadingEngineExporterMap::const_iterator it = m_shadingEngineExporters.begin(), e = m_shadingEngineExporters.end(); it != e; ++it)
+        {
+            if (getDependencyNodeByName(it->first, node))
+                addNodeDirtyCallback(node);
+        }
+
+        for(size_t i = 0; i < NumShadingNetworkContexts; ++i)
+        {
+            for(ShadingNetworkExporterMap::const_iterator it = m_shadingNetworkExporters[i].begin(), e = m_shadingNetworkExporters[i].end(); it != e; ++it)
+            {
+                if (getDependencyNodeByName(it->first, node))
+                    addNodeDirtyCallback(node);
+            }
+        }
+
+        for(AlphaMapExporterMap::const_iterator it = m_alphaMapExporters.begin(), e = m_alphaMapExporters.end(); it != e; ++it)
+        {
+            if (getDependencyNodeByName(it->first, node))
+                addNodeDirtyCallback(node);
+        }
+
+        // Render globals. Settings only used by the renderer are applied on reuse.
+        if (getDependencyNodeByName("appleseedRenderGlobals", node))
+        {
+            MCallbackId id = MNodeMessage::addAttributeChangedCallback(
+                node,
+                &SessionImpl::globalsChangedCallback,
+                this,
+                &status);
+
+            if (status)
+                m_callbackIds.append(id);
+        }
+
+        // Scene structure.
+        MCallbackId id = MDGMessage::addNodeAddedCallback(
+            &SessionImpl::nodeChangedCallback,
+            MString("dependNode"),
+            this,
+            &status);
+
+        if (status)
+            m_callbackIds.append(id);
+
+        id = MDGMessage::addNodeRemovedCallback(
+            &SessionImpl::nodeChangedCallback,
+            MString("dependNode"),
+            this,
+            &status);
+
+        if (status)
+            m_callbackIds.append(id);
+
+        id = MDagMessage::addAllDagChangesCallback(
+            &SessionImpl::dagChangedCallback,
+            this,
+            &status);
+
+        if (status)
+            m_callbackIds.append(id);
+
+        id = MDGMessage::addConnectionCallback(
+            &SessionImpl::connectionChangedCallback,
+            this,
+            &status);
+
+        if (status)
+            m_callbackIds.append(id);
+
+        id = MSceneMessage::addCallback(
+            MSceneMessage::kBeforeNew,
+            &SessionImpl::sceneChangedCallback,
+            this,
+            &status);
+
+        if (status)
+            m_callbackIds.append(id);
+
+        id = MSceneMessage::addCallback(
+            MSceneMessage::kBeforeOpen,
+            &SessionImpl::sceneChangedCallback,
+            this,
+            &status);
+
+        if (status)
+            m_callbackIds.append(id);
+
+        m_exportTime = MAnimControl::currentTime();
+        m_sceneChanged = false;
+    }
+
+    typedef std::set<MString, MStringCompareLess> WatchedDagPathSet;
+
+    // Watch a dag node and its parents, stopping at the first parent already watched.
+    void watchDagPath(const MDagPath& dagPath, WatchedDagPathSet& watchedPaths)
+    {
+        MDagPath path(dagPath);
+        while (path.length() > 0)
+        {
+            if (!watchedPaths.insert(path.fullPathName()).second)
+                return;
+
+            MObject node = path.node();
+            addNodeDirtyCallback(node);
+            path.pop();
+        }
+    }
+
+    void addNodeDirtyCallback(MObject& node)
+    {
+        MStatus status;
+        MCallbackId id = MNodeMessage::addNodeDirtyCallback(
+            node,
+            &SessionImpl::nodeChangedCallback,
+            this,
+            &status);
+
+        if (status)
+            m_callbackIds.append(id);
+    }
+
+    static void nodeChangedCallback(MObject& node, void* clientData)
+    {
+        static_cast<SessionImpl*>(clientData)->m_sceneChanged = true;
+    }
+
+    static void connectionChangedCallback(MPlug& srcPlug, MPlug& dstPlug, bool made, void* clientData)
+    {
+        static_cast<SessionImpl*>(clientData)->m_sceneChanged = true;
+    }
+
+    static void dagChangedCallback(
+        MDagMessage::DagMessage         msgType,
+        MDagPath&                       child,
+        MDagPath&                       parent,
+        void*                           clientData)
+    {
+        static_cast<SessionImpl*>(clientData)->m_sceneChanged = true;
+    }
+
+    static void sceneChangedCallback(void* clientData)
+    {
+        static_cast<SessionImpl*>(clientData)->m_sceneChanged = true;
+    }
+
+    static void globalsChangedCallback(
+        MNodeMessage::AttributeMessage  msg,
+        MPlug&                          plug,
+        MPlug&                          otherPlug,
+        void*                           clientData)
+    {
+        if (msg & MNodeMessage::kAttributeSet)
+        {
+            // Render globals that only affect the renderer configurations or the frame.
+            static const char* renderSettings[] =
+            {
+                "samples", "passes", "pixelSampler", "minPixelSamples", "maxPixelSamples",
+                "noiseThreshold", "tileSize", "progressiveRender", "timeLimit",
+                "progressiveMaxSamples", "convergenceThreshold", "checkpointInterval",
+                "lightingEngine", "diagnostics", "limitBounces", "bounces",
+                "specularBounces", "glossyBounces", "diffuseBounces", "lightSamples",
+                "envSamples", "caustics", "maxRayIntensity", "threads",
+                "renderInSeparateProcess", "imageFormat"
+            };
+
+            const MString attrName = MFnAttribute(plug.attribute()).name();
+            for (size_t i = 0, e = sizeof(renderSettings) / sizeof(renderSettings[0]); i < e; ++i)
+            {
+                if (attrName == renderSettings[i])
+                    return;
+            }
+        }
+
+        static_cast<SessionImpl*>(clientData)->m_sceneChanged = true;
+    }
+
+    // Return true if this session's project can be used to render with the given options.
+    bool canReuse(const AppleseedSession::Options& options) const
+    {
+        return
+            m_sessionMode == AppleseedSession::FinalRenderSession &&
+            m_callbackIds.length() != 0 &&
+            !m_sceneChanged &&
+            m_exportTime == MAnimControl::currentTime() &&
+            m_options.m_selectionOnly == options.m_selectionOnly &&
+            m_options.m_width == options.m_width &&
+            m_options.m_height == options.m_height &&
+            m_options.m_camera == options.m_camera &&
+            std::strcmp(m_options.m_colorspace, options.m_colorspace) == 0;
+    }
+
+    // Update the render settings and the frame of a reused project.
+    void reuse(const AppleseedSession::Options& options, ComputationPtr computation)
+    {
+        m_options = options;
+        m_computation = computation;
+
+        initializeConfigurations();
+        MObject globalsNode = exportAppleseedRenderGlobals();
+        createFrame(m_project->get_frame()->get_parameters(), globalsNode);
+    }
+
+    // Stop rendering and release everything not needed to render the project again.
+    bool keepWarm()
+    {
+        if (m_callbackIds.length() == 0 || m_sceneChanged)
+            return false;
+
+        abortRender();
+        m_renderer.reset();
+        m_tileCallbackFactory.reset();
+        m_renderingThreads.release();
+        m_computation.reset();
+        return true;
     }
 
     bool writeProject() const
     {
+        if (m_options.m_packProject)
+        {
+            // appleseed only packs the assets of the entities it knows about,
+            // not the textures referenced by shader parameters. Write the project
+            // next to the staged geometry and textures and archive all of them.
+            const bfs::path projectFileName =
+                m_stagingPath / bfs::path(m_fileName.asChar()).filename().replace_extension(".appleseed");
+
+            if (!writeProject(projectFileName.string().c_str()))
+                return false;
+
+            try
+            {
+                asf::zip(m_fileName.asChar(), m_stagingPath.string());
+            }
+            catch (const std::exception& e)
+            {
+                RENDERER_LOG_ERROR("Couldn't write packed project %s: %s", m_fileName.asChar(), e.what());
+                return false;
+            }
+
+            return true;
+        }
+
         return writeProject(m_fileName.asChar());
     }
 
+    // Enable delta sequence export. The static scene is written next to the
+    // project of the frame, and exported only if exportStaticScene is true.
+    void setStaticScene(const MString& fileName, const bool exportStaticScene)
+    {
+        m_staticSceneFileName = fileName;
+
+        if (exportStaticScene)
+            m_staticAssembly = asr::AssemblyFactory().create("assembly", asr::ParamArray());
+    }
+
+    bool writeStaticScene()
+    {
+        assert(m_staticAssembly.get());
+
+        const bfs::path fileName = m_projectPath / m_staticSceneFileName.asChar();
+
+        // The archive assembly loading the static scene takes
+        // the contents of the assembly named "assembly".
+        asf::auto_release_ptr<asr::Project> project(asr::ProjectFactory::create("static_scene"));
+        project->set_path(fileName.string().c_str());
+
+        asf::auto_release_ptr<asr::Scene> scene = asr::SceneFactory::create();
+        project->set_scene(scene);
+        project->get_scene()->assemblies().insert(m_staticAssembly);
+
+        return writeProject(*project, fileName.string().c_str());
+    }
+
     bool writeProject(const char *filename) const
+    {
+        return writeProject(*m_project, filename);
+    }
+
+    static bool writeProject(const asr::Project& project, const char *filename)
     {
         return asr::ProjectFileWriter::write(
-            *m_project,
+            project,
             filename,
             asr::ProjectFileWriter::OmitHandlingAssetFiles |
             asr::ProjectFileWriter::OmitWritingGeometryFiles);
@@ -825,6 +1789,20 @@ struct SessionImpl
         return scene->assemblies().get_by_name("assembly");
     }
 
+    typedef std::map<MString, AppleseedSession::MotionBlurTimes, MStringCompareLess> DagMotionBlurTimesMap;
+
+    static const AppleseedSession::MotionBlurTimes& dagNodeMotionBlurTimes(
+        const MString&                              name,
+        const AppleseedSession::MotionBlurTimes&    motionBlurTimes,
+        const DagMotionBlurTimesMap&                dagMotionBlurTimes)
+    {
+        if (dagMotionBlurTimes.empty())
+            return motionBlurTimes;
+
+        DagMotionBlurTimesMap::const_iterator it = dagMotionBlurTimes.find(name);
+        return it != dagMotionBlurTimes.end() ? it->second : motionBlurTimes;
+    }
+
     void checkUserAborted() const
     {
         if (m_computation)
@@ -836,6 +1814,8 @@ struct SessionImpl
     typedef std::map<MString, ShadingNetworkExporterPtr, MStringCompareLess>    ShadingNetworkExporterMap;
     typedef boost::array<ShadingNetworkExporterMap, NumShadingNetworkContexts>  ShadingNetworkExporterMapArray;
     typedef std::map<MString, AlphaMapExporterPtr, MStringCompareLess>          AlphaMapExporterMap;
+    typedef std::map<MString, ShapeExporterPtr, MStringCompareLess>             InstanceMasterMap;
+    typedef std::map<MString, AssemblyExporterPtr, MStringCompareLess>          AssemblyMasterMap;
 
     AppleseedSession::SessionMode                           m_sessionMode;
     AppleseedSession::Options                               m_options;
@@ -847,23 +1827,64 @@ struct SessionImpl
 
     MString                                                 m_fileName;
     bfs::path                                               m_projectPath;
+    bfs::path                                               m_stagingPath;
 
     DagExporterMap                                          m_dagExporters;
+    DagExporterMap                                          m_staticDagExporters;
     ShadingEngineExporterMap                                m_shadingEngineExporters;
     ShadingNetworkExporterMapArray                          m_shadingNetworkExporters;
     AlphaMapExporterMap                                     m_alphaMapExporters;
+    InstanceMasterMap                                       m_instanceMasters;
+    AssemblyMasterMap                                       m_assemblyMasters;
+    UniqueNameAllocator                                     m_nameAllocator;
+    TransformCache                                          m_transformCache;
+
+    MString                                                 m_staticSceneFileName;
+    asf::auto_release_ptr<asr::Assembly>                    m_staticAssembly;
 
     boost::scoped_ptr<asr::MasterRenderer>                  m_renderer;
     RendererController                                      m_rendererController;
     asf::auto_release_ptr<RenderViewTileCallbackFactory>    m_tileCallbackFactory;
+    asf::auto_release_ptr<asr::ITileCallbackFactory>        m_batchTileCallbackFactory;
+    boost::scoped_ptr<RenderCheckpoint>                     m_checkpoint;
+    boost::scoped_ptr<RenderProcess>                        m_renderProcess;
+    bfs::path                                               m_renderProcessPath;
 
     boost::thread                                           m_renderThread;
+    ThreadBudget::ScopedReservation                         m_renderingThreads;
+
+    MCallbackIdArray                                        m_callbackIds;
+    MDagPathArray                                           m_hiddenDagPaths;
+    MTime                                                   m_exportTime;
+    bool                                                    m_sceneChanged;
 };
 
 // Globals.
 bfs::path                       g_pluginPath;    // Plugin path.
 MTime                           g_savedTime;     // Saved time.
 boost::scoped_ptr<SessionImpl>  g_globalSession; // Global session.
+boost::scoped_ptr<SessionImpl>  g_warmSession;   // Finished session kept for reuse.
+
+MString renderProcessExecutable()
+{
+    if (const char* executable = std::getenv("APPLESEED_MAYA_RENDER_EXECUTABLE"))
+        return MString(executable);
+
+    // The plugin is installed in plug-ins/<maya version> and the executable in bin.
+    bfs::path executable = g_pluginPath.parent_path().parent_path() / "bin" / "appleseedMayaRender";
+#ifdef _WIN32
+    executable.replace_extension(".exe");
+#endif
+
+    return MString(executable.string().c_str());
+}
+
+MString renderProcessSchema()
+{
+    // The project schema is deployed next to the bin directory.
+    const bfs::path schema = g_pluginPath.parent_path().parent_path() / "schemas" / "project.xsd";
+    return MString(schema.string().c_str());
+}
 
 } // unnamed
 
@@ -879,6 +1900,7 @@ MStatus initialize(const MString& pluginPath)
 MStatus uninitialize()
 {
     g_globalSession.reset();
+    g_warmSession.reset();
     return MS::kSuccess;
 }
 
@@ -890,6 +1912,7 @@ void beginSession(
     const AppleseedSession::Options&    options,
     ComputationPtr                      computation)
 {
+    g_warmSession.reset();
     g_globalSession.reset(new SessionImpl(mode, options, computation));
 }
 
@@ -898,6 +1921,7 @@ void beginSession(
     const AppleseedSession::Options&    options,
     ComputationPtr                      computation)
 {
+    g_warmSession.reset();
     g_globalSession.reset(new SessionImpl(fileName, options, computation));
 }
 
@@ -924,6 +1948,30 @@ MStatus projectExport(
             return MS::kFailure;
         }
 
+        // Packed projects are self contained and can't share a static scene.
+        if (options.m_packProject && options.m_deltaSequence)
+        {
+            RENDERER_LOG_WARNING("Delta sequences are not supported by packed projects, disabling.");
+            options.m_deltaSequence = false;
+        }
+
+        // Name the static scene of delta sequences after the frame projects,
+        // replacing the frame placeholders by "static".
+        MString staticSceneFileName;
+        if (options.m_deltaSequence)
+        {
+            std::string name = bfs::path(fname_template).filename().string();
+            const size_t first = name.find('#');
+            if (first != std::string::npos)
+            {
+                const size_t last = name.find_first_not_of('#', first);
+                name.replace(first, last == std::string::npos ? std::string::npos : last - first, "static");
+            }
+            else
+                name = "static_" + name;
+            staticSceneFileName = name.c_str();
+        }
+
         for(int frame = options.m_firstFrame; frame <= options.m_lastFrame; frame += options.m_frameStep)
         {
             if (computation->isInterruptRequested())
@@ -937,7 +1985,22 @@ MStatus projectExport(
             try
             {
                 beginSession(fname.c_str(), options, computation);
+
+                const bool isFirstFrame = frame == options.m_firstFrame;
+                if (options.m_deltaSequence)
+                    g_globalSession->setStaticScene(staticSceneFileName, isFirstFrame);
+
                 g_globalSession->exportProject();
+
+                if (options.m_deltaSequence && isFirstFrame)
+                {
+                    if (!g_globalSession->writeStaticScene())
+                    {
+                        RENDERER_LOG_ERROR("Couldn't write the static scene of the sequence.");
+                        return MS::kFailure;
+                    }
+                }
+
                 g_globalSession->writeProject();
             }
             catch (const AbortRequested&)
@@ -984,11 +2047,28 @@ MStatus render(Options options)
 
     try
     {
-        beginSession(FinalRenderSession, options, computation);
-        g_globalSession->exportProject();
+        // Skip the export if nothing changed since the previous render.
+        if (g_warmSession && g_warmSession->canReuse(options))
+        {
+            RENDERER_LOG_INFO("Scene unchanged, reusing the previous render session");
+            g_globalSession.swap(g_warmSession);
+            g_globalSession->reuse(options, computation);
+        }
+        else
+        {
+            beginSession(FinalRenderSession, options, computation);
+            g_globalSession->exportProject();
 
-        if (computation->isInterruptRequested())
-            return MS::kSuccess;
+            if (computation->isInterruptRequested())
+                return MS::kSuccess;
+
+            // Restore the time before watching the scene, the export
+            // changes it when motion blur is enabled.
+            if (g_savedTime != MAnimControl::currentTime())
+                MGlobal::viewFrame(g_savedTime);
+
+            g_globalSession->trackSceneChanges();
+        }
 
         g_globalSession->finalRender();
     }
@@ -1043,8 +2123,9 @@ MStatus batchRenderFrame(
 
         beginSession(FinalRenderSession, options, ComputationPtr());
         g_globalSession->exportProject();
-        g_globalSession->batchRender();
+        g_globalSession->batchRender(outputFilename);
         g_globalSession->writeMainImage(outputFilename.asChar());
+        g_globalSession->removeCheckpoint();
     }
     catch (const AppleseedMayaException&)
     {
@@ -1167,6 +2248,10 @@ void endSession()
 {
     if (g_globalSession.get())
     {
+        // Keep finished final renders around, in case the scene is rendered again.
+        if (g_globalSession->keepWarm())
+            g_warmSession.swap(g_globalSession);
+
         g_globalSession.reset();
 
         if (g_savedTime != MAnimControl::currentTime())
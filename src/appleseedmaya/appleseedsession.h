@@ -87,6 +87,14 @@ struct Options
     int         m_firstFrame;
     int         m_lastFrame;
     int         m_frameStep;
+
+    // Write the non animated shapes of a sequence once, to a static
+    // project referenced by the projects of all the frames.
+    bool        m_deltaSequence;
+
+    // Write a single .appleseedz archive containing
+    // the project, its geometry and its textures.
+    bool        m_packProject;
 };
 
 struct MotionBlurTimes
@@ -100,6 +100,10 @@ MStatus AppleseedTranslator::writer(
                 options.m_lastFrame = atoi(optNameValue[1].c_str());
             else if (optNameValue[0] == "stepFrame")
                 options.m_frameStep = atoi(optNameValue[1].c_str());
+            else if (optNameValue[0] == "deltaSequence")
+                options.m_deltaSequence = (optNameValue[1] == "true");
+            else if (optNameValue[0] == "packProject")
+                options.m_packProject = (optNameValue[1] == "true");
             else
             {
                 RENDERER_LOG_WARNING(
@@ -31,6 +31,8 @@
 
 // Maya headers.
 #include <maya/MFnMatrixData.h>
+#include <maya/MNodeClass.h>
+#include <maya/MTypeId.h>
 
 namespace
 {
@@ -56,6 +58,40 @@ MStatus get3(const MPlug& plug, T& x, T& y, T& z)
 namespace AttributeUtils
 {
 
+CachedAttribute::CachedAttribute(const MString& name)
+  : m_name(name)
+{
+}
+
+const MString& CachedAttribute::name() const
+{
+    return m_name;
+}
+
+MPlug CachedAttribute::findPlug(const MFnDependencyNode& depNodeFn, MStatus* status) const
+{
+    const MTypeId typeId = depNodeFn.typeId();
+
+    AttributeMap::const_iterator it = m_attributes.find(typeId.id());
+    if (it == m_attributes.end())
+    {
+        // A null attribute means the node type does not have it.
+        MNodeClass nodeClass(typeId);
+        it = m_attributes.insert(
+            std::make_pair(typeId.id(), nodeClass.attribute(m_name))).first;
+    }
+
+    if (!it->second.isNull())
+    {
+        if (status)
+            *status = MS::kSuccess;
+
+        return MPlug(depNodeFn.object(), it->second);
+    }
+
+    return depNodeFn.findPlug(m_name, status);
+}
+
 MStatus get(const MPlug& plug, MAngle& value)
 {
     return plug.getValue(value);
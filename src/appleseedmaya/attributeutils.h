@@ -29,6 +29,9 @@
 #ifndef APPLESEED_MAYA_ATTRIBUTE_UTILS_H
 #define APPLESEED_MAYA_ATTRIBUTE_UTILS_H
 
+// Standard headers.
+#include <map>
+
 // Maya headers.
 #include <maya/MAngle.h>
 #include <maya/MColor.h>
@@ -46,6 +49,32 @@
 namespace AttributeUtils
 {
 
+//
+// CachedAttribute.
+//
+//  Attribute looked up by name once per node type. Static and extension
+//  attributes are shared by all the nodes of a type, so plugs can then be
+//  built from the resolved attribute without searching by name.
+//
+
+class CachedAttribute
+{
+  public:
+    explicit CachedAttribute(const MString& name);
+
+    const MString& name() const;
+
+    // Return the plug for this attribute of the node.
+    // Dynamic attributes are still found by name.
+    MPlug findPlug(const MFnDependencyNode& depNodeFn, MStatus* status = 0) const;
+
+  private:
+    typedef std::map<unsigned int, MObject> AttributeMap;
+
+    MString                 m_name;
+    mutable AttributeMap    m_attributes;
+};
+
 template<class T>
 MStatus get(const MPlug& plug, T& value)
 {
@@ -76,6 +105,24 @@ MStatus get(const MObject& node, const MString& attrName, T& value)
     return get(depNodeFn, attrName, value);
 }
 
+template<class T>
+MStatus get(const MFnDependencyNode& depNodeFn, const CachedAttribute& attr, T& value)
+{
+    MStatus status;
+    MPlug plug = attr.findPlug(depNodeFn, &status);
+    if (!status)
+        return status;
+
+    return get(plug, value);
+}
+
+template<class T>
+MStatus get(const MObject& node, const CachedAttribute& attr, T& value)
+{
+    MFnDependencyNode depNodeFn(node);
+    return get(depNodeFn, attr, value);
+}
+
 MStatus getPlugConnectedTo(const MPlug& dstPlug, MPlug& srcPlug);
 
 bool hasConnections(const MPlug& plug, bool input);
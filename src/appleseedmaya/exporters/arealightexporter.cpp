@@ -29,6 +29,10 @@
 // Interface header.
 #include "appleseedmaya/exporters/arealightexporter.h"
 
+// Standard headers.
+#include <map>
+#include <utility>
+
 // Maya headers.
 #include <maya/MFnDagNode.h>
 
@@ -36,7 +40,10 @@
 #include "foundation/math/scalar.h"
 
 // appleseed.renderer headers.
+#include "renderer/api/material.h"
+#include "renderer/api/object.h"
 #include "renderer/api/scene.h"
+#include "renderer/api/utility.h"
 
 // appleseed.maya headers.
 #include "appleseedmaya/attributeutils.h"
@@ -46,6 +53,40 @@
 namespace asf = foundation;
 namespace asr = renderer;
 
+namespace
+{
+
+// All area lights instance the same quad and back material.
+const char* AreaLightQuadName = "area_light_quad";
+const char* AreaLightBackMaterialName = "area_light_back_material";
+
+// Number of area lights using each shared entity, by assembly and entity name.
+typedef std::map<std::pair<const asr::Assembly*, std::string>, size_t> SharedEntityUsersMap;
+SharedEntityUsersMap g_sharedEntityUsers;
+
+void addSharedEntityUser(const asr::Assembly& assembly, const char* name)
+{
+    ++g_sharedEntityUsers[std::make_pair(&assembly, std::string(name))];
+}
+
+// Return true if this was the last user of the entity.
+bool removeSharedEntityUser(const asr::Assembly& assembly, const char* name)
+{
+    SharedEntityUsersMap::iterator it =
+        g_sharedEntityUsers.find(std::make_pair(&assembly, std::string(name)));
+
+    if (it == g_sharedEntityUsers.end())
+        return false;
+
+    if (--it->second != 0)
+        return false;
+
+    g_sharedEntityUsers.erase(it);
+    return true;
+}
+
+}
+
 void AreaLightExporter::registerExporter()
 {
     NodeExporterFactory::registerDagNodeExporter("areaLight", &AreaLightExporter::create);
@@ -56,9 +97,6 @@ DagNodeExporter *AreaLightExporter::create(
     asr::Project&                               project,
     AppleseedSession::SessionMode               sessionMode)
 {
-    if (areObjectAndParentsRenderable(path) == false)
-        return 0;
-
     return new AreaLightExporter(path, project, sessionMode);
 }
 
@@ -67,18 +105,32 @@ AreaLightExporter::AreaLightExporter(
     asr::Project&                               project,
     AppleseedSession::SessionMode               sessionMode)
   : DagNodeExporter(path, project, sessionMode)
+  , m_flushed(false)
 {
 }
 
 AreaLightExporter::~AreaLightExporter()
 {
-    if (sessionMode() == AppleseedSession::ProgressiveRenderSession)
-    {
-        mainAssembly().materials().remove(m_material.get());
-        mainAssembly().materials().remove(m_backMaterial.get());
-        mainAssembly().objects().remove(m_lightMesh.get());
+    if (!m_flushed)
+        return;
+
+    const bool removeEntities = sessionMode() == AppleseedSession::ProgressiveRenderSession;
+
+    if (removeEntities)
         mainAssembly().object_instances().remove(m_objectInstance.get());
-    }
+
+    // The quad and the materials are shared with other lights,
+    // remove them with their last user.
+    asr::Assembly& assembly = mainAssembly();
+
+    if (removeSharedEntityUser(assembly, m_materialName.asChar()) && removeEntities)
+        assembly.materials().remove(assembly.materials().get_by_name(m_materialName.asChar()));
+
+    if (removeSharedEntityUser(assembly, AreaLightBackMaterialName) && removeEntities)
+        assembly.materials().remove(assembly.materials().get_by_name(AreaLightBackMaterialName));
+
+    if (removeSharedEntityUser(assembly, AreaLightQuadName) && removeEntities)
+        assembly.objects().remove(assembly.objects().get_by_name(AreaLightQuadName));
 }
 
 bool AreaLightExporter::supportsMotionBlur() const
@@ -98,62 +150,80 @@ void AreaLightExporter::createEntities(
     const AppleseedSession::Options&            options,
     const AppleseedSession::MotionBlurTimes&    motionBlurTimes)
 {
-    MString objectName = appleseedName();
+    asf::Matrix4d m = convert(assemblyMatrix());
 
-    asr::ParamArray params;
-    params.insert("primitive", "grid");
-    params.insert("resolution_u", 1);
-    params.insert("resolution_v", 1);
-    params.insert("width", 2.0f);
-    params.insert("height", 2.0f);
+    // Rotate to match Maya's default light orientation and UVs.
+    m = m * asf::Matrix4d::make_rotation_x(asf::deg_to_rad(-90.0));
+    m = m * asf::Matrix4d::make_rotation_y(asf::deg_to_rad(180.0));
+    m_transform = asf::Transformd(m);
+}
 
-    if (sessionMode() == AppleseedSession::ExportSession)
-        m_lightMesh.reset(asr::MeshObjectFactory::create(objectName.asChar(), params));
-    else
-        m_lightMesh.reset(asr::create_primitive_mesh(objectName.asChar(), params));
+void AreaLightExporter::flushEntities()
+{
+    // Lights with the same shader group share the emission material.
+    MString materialName("area_light_material");
+    if (m_lightNetworkExporter)
+        materialName = m_lightNetworkExporter->shaderGroupName() + MString("_material");
+
+    m_materialName = materialName;
+    m_flushed = true;
 
-    MString materialName = objectName + MString("_area_light_material");
-    m_material.reset(asr::OSLMaterialFactory().create(materialName.asChar(), asr::ParamArray()));
+    addSharedEntityUser(mainAssembly(), materialName.asChar());
+    addSharedEntityUser(mainAssembly(), AreaLightBackMaterialName);
+    addSharedEntityUser(mainAssembly(), AreaLightQuadName);
+
+    if (mainAssembly().materials().get_by_name(materialName.asChar()) == 0)
+    {
+        asr::ParamArray params;
+        if (m_lightNetworkExporter)
+            params.insert("osl_surface", m_lightNetworkExporter->shaderGroupName().asChar());
+
+        mainAssembly().materials().insert(
+            asr::OSLMaterialFactory().create(materialName.asChar(), params));
+    }
+
+    if (mainAssembly().materials().get_by_name(AreaLightBackMaterialName) == 0)
+    {
+        mainAssembly().materials().insert(
+            asr::GenericMaterialFactory().create(AreaLightBackMaterialName, asr::ParamArray()));
+    }
+
+    if (mainAssembly().objects().get_by_name(AreaLightQuadName) == 0)
+    {
+        asr::ParamArray params;
+        params.insert("primitive", "grid");
+        params.insert("resolution_u", 1);
+        params.insert("resolution_v", 1);
+        params.insert("width", 2.0f);
+        params.insert("height", 2.0f);
+
+        asf::auto_release_ptr<asr::MeshObject> quad;
+        if (sessionMode() == AppleseedSession::ExportSession)
+            quad = asr::MeshObjectFactory::create(AreaLightQuadName, params);
+        else
+            quad = asr::create_primitive_mesh(AreaLightQuadName, params);
+
+        mainAssembly().objects().insert(asf::auto_release_ptr<asr::Object>(quad.release()));
+    }
 
     asf::StringDictionary frontMaterialMappings;
     frontMaterialMappings.insert("default", materialName.asChar());
 
-    MString backMaterialName = objectName + MString("_area_light_back_material");
-    m_backMaterial.reset(asr::GenericMaterialFactory().create(backMaterialName.asChar(), asr::ParamArray()));
-
     asf::StringDictionary backMaterialMappings;
-    backMaterialMappings.insert("default", backMaterialName.asChar());
+    backMaterialMappings.insert("default", AreaLightBackMaterialName);
 
-    asf::Matrix4d m = convert(dagPath().inclusiveMatrix());
-
-    // Rotate to match Maya's default light orientation and UVs.
-    m = m * asf::Matrix4d::make_rotation_x(asf::deg_to_rad(-90.0));
-    m = m * asf::Matrix4d::make_rotation_y(asf::deg_to_rad(180.0));
-    params.clear();
+    asr::ParamArray params;
+    visibilityAttributesToParams(params);
 
     const MString objectInstanceName = appleseedName() + MString("_instance");
-    visibilityAttributesToParams(params);
     m_objectInstance.reset(
         asr::ObjectInstanceFactory::create(
             objectInstanceName.asChar(),
             params,
-            objectName.asChar(),
-            asf::Transformd(m),
+            AreaLightQuadName,
+            m_transform,
             frontMaterialMappings,
             backMaterialMappings));
-}
-
-void AreaLightExporter::flushEntities()
-{
-    if (m_lightNetworkExporter)
-    {
-        m_material->get_parameters().insert(
-            "osl_surface",
-            m_lightNetworkExporter->shaderGroupName().asChar());
-    }
 
-    mainAssembly().materials().insert(m_material.release());
-    mainAssembly().materials().insert(m_backMaterial.release());
-    mainAssembly().objects().insert(m_lightMesh.releaseAs<asr::Object>());
     mainAssembly().object_instances().insert(m_objectInstance.release());
 }
@@ -32,8 +32,10 @@
 // Standard headers.
 #include<string>
 
+// appleseed.foundation headers.
+#include "foundation/math/transform.h"
+
 // appleseed.renderer headers.
-#include "renderer/api/material.h"
 #include "renderer/api/object.h"
 #include "renderer/api/scene.h"
 
@@ -75,10 +77,10 @@ class AreaLightExporter
       renderer::Project&                            project,
       AppleseedSession::SessionMode                 sessionMode);
 
-    AppleseedEntityPtr<renderer::MeshObject>        m_lightMesh;
+    foundation::Transformd                          m_transform;
+    MString                                         m_materialName;
+    bool                                            m_flushed;
     AppleseedEntityPtr<renderer::ObjectInstance>    m_objectInstance;
-    AppleseedEntityPtr<renderer::Material>          m_material;
-    AppleseedEntityPtr<renderer::Material>          m_backMaterial;
     ShadingNetworkExporterPtr                       m_lightNetworkExporter;
 };
 
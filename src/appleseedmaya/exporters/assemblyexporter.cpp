@@ -0,0 +1,142 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "appleseedmaya/exporters/assemblyexporter.h"
+
+// Standard headers.
+#include <cassert>
+
+// Maya headers.
+#include <maya/MFnDependencyNode.h>
+
+// appleseed.maya headers.
+#include "appleseedmaya/attributeutils.h"
+#include "appleseedmaya/logger.h"
+#include "appleseedmaya/transformcache.h"
+
+namespace asf = foundation;
+namespace asr = renderer;
+
+namespace
+{
+
+const AttributeUtils::CachedAttribute g_asExportAsAssembly("asExportAsAssembly");
+
+}
+
+bool AssemblyExporter::isAssembly(const MDagPath& path)
+{
+    if (!path.hasFn(MFn::kTransform))
+        return false;
+
+    bool exportAsAssembly = false;
+    AttributeUtils::get(path.node(), g_asExportAsAssembly, exportAsAssembly);
+    return exportAsAssembly;
+}
+
+AssemblyExporter* AssemblyExporter::create(
+    const MDagPath&                             path,
+    asr::Project&                               project,
+    AppleseedSession::SessionMode               sessionMode)
+{
+    return new AssemblyExporter(path, project, sessionMode, 0);
+}
+
+AssemblyExporter* AssemblyExporter::createInstance(
+    const MDagPath&                             path,
+    asr::Project&                               project,
+    AppleseedSession::SessionMode               sessionMode,
+    const AssemblyExporter&                     master)
+{
+    return new AssemblyExporter(path, project, sessionMode, &master);
+}
+
+AssemblyExporter::AssemblyExporter(
+    const MDagPath&                             path,
+    asr::Project&                               project,
+    AppleseedSession::SessionMode               sessionMode,
+    const AssemblyExporter*                     master)
+  : DagNodeExporter(path, project, sessionMode)
+  , m_master(master)
+{
+    // The assembly is created upfront, as the exporters
+    // of the children need it before entities are created.
+    if (m_master == 0)
+    {
+        m_assembly.reset(
+            asr::AssemblyFactory().create(assemblyName().asChar(), asr::ParamArray()));
+    }
+}
+
+void AssemblyExporter::addExporter(DagNodeExporter& exporter)
+{
+    assert(m_master == 0);
+    exporter.setParentAssembly(*m_assembly, dagPath());
+}
+
+MString AssemblyExporter::assemblyName() const
+{
+    if (m_master)
+        return m_master->assemblyName();
+
+    return appleseedName() + MString("_assembly");
+}
+
+void AssemblyExporter::createEntities(
+    const AppleseedSession::Options&            options,
+    const AppleseedSession::MotionBlurTimes&    motionBlurTimes)
+{
+}
+
+void AssemblyExporter::exportTransformMotionStep(float time, TransformCache& transformCache)
+{
+    m_transformSequence.set_transform(time, assemblyTransform(transformCache));
+}
+
+void AssemblyExporter::flushEntities()
+{
+    m_transformSequence.optimize();
+
+    if (m_assembly.get())
+        mainAssembly().assemblies().insert(m_assembly.release());
+    else
+        RENDERER_LOG_DEBUG("Flushing instance of group %s", m_master->appleseedName().asChar());
+
+    const MString assemblyInstanceName = appleseedName() + MString("_assembly_instance");
+    asr::ParamArray params;
+    visibilityAttributesToParams(params);
+    m_assemblyInstance.reset(
+        asr::AssemblyInstanceFactory::create(
+            assemblyInstanceName.asChar(),
+            params,
+            assemblyName().asChar()));
+
+    m_assemblyInstance->transform_sequence() = m_transformSequence;
+    mainAssembly().assembly_instances().insert(m_assemblyInstance.release());
+}
@@ -0,0 +1,100 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_MAYA_EXPORTERS_ASSEMBLYEXPORTER_H
+#define APPLESEED_MAYA_EXPORTERS_ASSEMBLYEXPORTER_H
+
+// Maya headers.
+#include <maya/MString.h>
+
+// appleseed.renderer headers.
+#include "renderer/api/scene.h"
+#include "renderer/api/utility.h"
+
+// appleseed.maya headers.
+#include "appleseedmaya/exporters/dagnodeexporter.h"
+
+// Forward declarations.
+namespace renderer { class Project; }
+
+//
+// Exporter for Maya groups exported as appleseed assemblies.
+// The entities of the dag nodes below the group are exported into the
+// assembly, with transforms relative to the group. Other dag paths
+// to an instanced group only create new instances of the assembly.
+//
+
+class AssemblyExporter
+  : public DagNodeExporter
+{
+  public:
+
+    // Return true if the transform node is exported as an assembly.
+    static bool isAssembly(const MDagPath& path);
+
+    static AssemblyExporter* create(
+      const MDagPath&                               path,
+      renderer::Project&                            project,
+      AppleseedSession::SessionMode                 sessionMode);
+
+    static AssemblyExporter* createInstance(
+      const MDagPath&                               path,
+      renderer::Project&                            project,
+      AppleseedSession::SessionMode                 sessionMode,
+      const AssemblyExporter&                       master);
+
+    // Make an exporter export its entities into this assembly.
+    void addExporter(DagNodeExporter& exporter);
+
+    MString assemblyName() const;
+
+    virtual void createEntities(
+        const AppleseedSession::Options&            options,
+        const AppleseedSession::MotionBlurTimes&    motionBlurTimes);
+
+    virtual void exportTransformMotionStep(float time, TransformCache& transformCache);
+
+    virtual void flushEntities();
+
+  private:
+
+    AssemblyExporter(
+      const MDagPath&                               path,
+      renderer::Project&                            project,
+      AppleseedSession::SessionMode                 sessionMode,
+      const AssemblyExporter*                       master);
+
+    const AssemblyExporter*                         m_master;
+    renderer::TransformSequence                     m_transformSequence;
+    AppleseedEntityPtr<renderer::Assembly>          m_assembly;
+    AppleseedEntityPtr<renderer::AssemblyInstance>  m_assemblyInstance;
+};
+
+typedef boost::shared_ptr<AssemblyExporter> AssemblyExporterPtr;
+
+#endif  // !APPLESEED_MAYA_EXPORTERS_ASSEMBLYEXPORTER_H
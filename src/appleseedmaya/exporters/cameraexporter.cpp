@@ -45,13 +45,14 @@
 // appleseed.maya headers.
 #include "appleseedmaya/attributeutils.h"
 #include "appleseedmaya/exporters/exporterfactory.h"
+#include "appleseedmaya/transformcache.h"
 
 namespace asf = foundation;
 namespace asr = renderer;
 
 void CameraExporter::registerExporter()
 {
-    NodeExporterFactory::registerDagNodeExporter("camera", &CameraExporter::create);
+    NodeExporterFactory::registerDagNodeExporter("camera", &CameraExporter::create, true);
 }
 
 DagNodeExporter *CameraExporter::create(
@@ -148,11 +149,9 @@ void CameraExporter::createEntities(
     m_camera = cameraFactory->create(appleseedName().asChar(), cameraParams);
 }
 
-void CameraExporter::exportCameraMotionStep(float time)
+void CameraExporter::exportCameraMotionStep(float time, TransformCache& transformCache)
 {
-    asf::Matrix4d m = convert(dagPath().inclusiveMatrix());
-    asf::Matrix4d invM = convert(dagPath().inclusiveMatrixInverse());
-    asf::Transformd xform(m, invM);
+    const asf::Transformd xform = transformCache.worldTransform(dagPath());
     m_camera->transform_sequence().set_transform(time, xform);
 }
 
@@ -53,7 +53,7 @@ class CameraExporter
         const AppleseedSession::Options&            options,
         const AppleseedSession::MotionBlurTimes&    motionBlurTimes);
 
-    virtual void exportCameraMotionStep(float time);
+    virtual void exportCameraMotionStep(float time, TransformCache& transformCache);
 
     virtual void flushEntities();
 
@@ -0,0 +1,407 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "appleseedmaya/exporters/curveexporter.h"
+
+// Standard headers.
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Boost headers.
+#include "boost/bind.hpp"
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
+#include "boost/thread/thread.hpp"
+
+// Maya headers.
+#include <maya/MDoubleArray.h>
+#include <maya/MFnNurbsCurve.h>
+#include <maya/MFnPfxGeometry.h>
+#include <maya/MPoint.h>
+#include <maya/MPointArray.h>
+#include <maya/MRenderLine.h>
+#include <maya/MRenderLineArray.h>
+#include <maya/MVectorArray.h>
+
+// appleseed.maya headers.
+#include "appleseedmaya/attributeutils.h"
+#include "appleseedmaya/exporters/exporterfactory.h"
+#include "appleseedmaya/logger.h"
+#include "appleseedmaya/murmurhash.h"
+
+namespace bfs = boost::filesystem;
+namespace asf = foundation;
+namespace asr = renderer;
+
+namespace
+{
+
+const AttributeUtils::CachedAttribute g_asRenderCurve("asRenderCurve");
+const AttributeUtils::CachedAttribute g_asCurveWidth("asCurveWidth");
+
+// Number of points sampled on each span of non linear NURBS curves.
+const int SamplesPerSpan = 4;
+
+// Below this number of strands, conversion threads cost more than they save.
+const size_t MinStrandsPerChunk = 2048;
+
+// Polylines read from Maya, stored as flat arrays.
+struct Strands
+{
+    std::vector<asr::GVector3>  m_points;
+    std::vector<asr::GScalar>   m_widths;
+
+    // Index of the first point of each strand, followed by the total number of points.
+    std::vector<size_t>         m_starts;
+
+    size_t size() const
+    {
+        return m_starts.empty() ? 0 : m_starts.size() - 1;
+    }
+};
+
+typedef std::vector<asr::Curve3Type> CurveVector;
+
+void readNurbsCurve(const MDagPath& path, Strands& strands)
+{
+    MFnNurbsCurve curveFn(path);
+
+    float width = 0.01f;
+    AttributeUtils::get(path.node(), g_asCurveWidth, width);
+
+    MPointArray points;
+    if (curveFn.degree() == 1)
+        curveFn.getCVs(points, MSpace::kObject);
+    else
+    {
+        double start, end;
+        curveFn.getKnotDomain(start, end);
+
+        const int numSamples = curveFn.numSpans() * SamplesPerSpan + 1;
+        points.setLength(numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double t = start + (end - start) * i / (numSamples - 1);
+            curveFn.getPointAtParam(t, points[i], MSpace::kObject);
+        }
+    }
+
+    strands.m_starts.push_back(0);
+    for (unsigned int i = 0, e = points.length(); i < e; ++i)
+    {
+        strands.m_points.push_back(
+            asr::GVector3(
+                static_cast<asr::GScalar>(points[i].x),
+                static_cast<asr::GScalar>(points[i].y),
+                static_cast<asr::GScalar>(points[i].z)));
+    }
+
+    strands.m_widths.assign(strands.m_points.size(), width);
+    strands.m_starts.push_back(strands.m_points.size());
+}
+
+void readPfxHair(const MDagPath& path, Strands& strands)
+{
+    MFnPfxGeometry pfxFn(path);
+
+    MRenderLineArray mainLines;
+    MRenderLineArray leafLines;
+    MRenderLineArray flowerLines;
+    pfxFn.getLineData(
+        mainLines,
+        leafLines,
+        flowerLines,
+        true,       // lines
+        false,      // twist
+        true,       // width
+        false,      // flatness
+        false,      // parameter
+        false,      // color
+        false,      // incandescence
+        false,      // transparency
+        false);     // world space
+
+    strands.m_starts.reserve(mainLines.length() + 1);
+    strands.m_starts.push_back(0);
+
+    for (int i = 0, e = mainLines.length(); i < e; ++i)
+    {
+        const MRenderLine line = mainLines.renderLine(i);
+        const MVectorArray points = line.getLine();
+        const MDoubleArray widths = line.getWidth();
+
+        if (points.length() < 2)
+            continue;
+
+        for (unsigned int j = 0, je = points.length(); j < je; ++j)
+        {
+            strands.m_points.push_back(
+                asr::GVector3(
+                    static_cast<asr::GScalar>(points[j].x),
+                    static_cast<asr::GScalar>(points[j].y),
+                    static_cast<asr::GScalar>(points[j].z)));
+
+            strands.m_widths.push_back(
+                static_cast<asr::GScalar>(j < widths.length() ? widths[j] : 0.0));
+        }
+
+        strands.m_starts.push_back(strands.m_points.size());
+    }
+
+    // The line arrays are allocated by Maya and must be freed explicitly.
+    mainLines.deleteArray();
+    leafLines.deleteArray();
+    flowerLines.deleteArray();
+}
+
+// Convert strands to cubic Bezier segments going through their points,
+// using Catmull-Rom tangents.
+void convertStrands(
+    const Strands&  strands,
+    const size_t    begin,
+    const size_t    end,
+    CurveVector&    curves)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        const size_t first = strands.m_starts[i];
+        const size_t last = strands.m_starts[i + 1] - 1;
+
+        for (size_t j = first; j < last; ++j)
+        {
+            const asr::GVector3& p0 = strands.m_points[j > first ? j - 1 : j];
+            const asr::GVector3& p1 = strands.m_points[j];
+            const asr::GVector3& p2 = strands.m_points[j + 1];
+            const asr::GVector3& p3 = strands.m_points[j + 1 < last ? j + 2 : last];
+
+            const asr::GVector3 ctrlPoints[4] =
+            {
+                p1,
+                p1 + (p2 - p0) / asr::GScalar(6.0),
+                p2 - (p3 - p1) / asr::GScalar(6.0),
+                p2
+            };
+
+            const asr::GScalar width =
+                (strands.m_widths[j] + strands.m_widths[j + 1]) * asr::GScalar(0.5);
+
+            curves.push_back(asr::Curve3Type(ctrlPoints, width));
+        }
+    }
+}
+
+// Convert strands in chunks, on worker threads for large grooms.
+void convertStrands(const Strands& strands, std::vector<CurveVector>& chunks)
+{
+    const size_t numStrands = strands.size();
+    const size_t maxChunks = (numStrands + MinStrandsPerChunk - 1) / MinStrandsPerChunk;
+    const size_t numChunks =
+        std::max<size_t>(std::min<size_t>(boost::thread::hardware_concurrency(), maxChunks), 1);
+
+    chunks.resize(numChunks);
+
+    if (numChunks == 1)
+    {
+        convertStrands(strands, 0, numStrands, chunks[0]);
+        return;
+    }
+
+    boost::thread_group threads;
+    for (size_t i = 0; i < numChunks; ++i)
+    {
+        threads.create_thread(
+            boost::bind(
+                static_cast<void (*)(const Strands&, size_t, size_t, CurveVector&)>(&convertStrands),
+                boost::cref(strands),
+                numStrands * i / numChunks,
+                numStrands * (i + 1) / numChunks,
+                boost::ref(chunks[i])));
+    }
+
+    threads.join_all();
+}
+
+} // unnamed.
+
+void CurveExporter::registerExporter()
+{
+    NodeExporterFactory::registerDagNodeExporter("nurbsCurve", &CurveExporter::createNurbsCurve);
+    NodeExporterFactory::registerDagNodeExporter("pfxHair", &CurveExporter::createPfxHair);
+}
+
+DagNodeExporter* CurveExporter::createNurbsCurve(
+    const MDagPath&                             path,
+    asr::Project&                               project,
+    AppleseedSession::SessionMode               sessionMode)
+{
+    // Most NURBS curves in a scene are rig controls or construction curves.
+    bool renderCurve = false;
+    AttributeUtils::get(path.node(), g_asRenderCurve, renderCurve);
+    if (!renderCurve)
+        return 0;
+
+    return new CurveExporter(path, project, sessionMode);
+}
+
+DagNodeExporter* CurveExporter::createPfxHair(
+    const MDagPath&                             path,
+    asr::Project&                               project,
+    AppleseedSession::SessionMode               sessionMode)
+{
+    return new CurveExporter(path, project, sessionMode);
+}
+
+CurveExporter::CurveExporter(
+    const MDagPath&                             path,
+    asr::Project&                               project,
+    AppleseedSession::SessionMode               sessionMode)
+  : ShapeExporter(path, project, sessionMode)
+{
+}
+
+CurveExporter::~CurveExporter()
+{
+    if (sessionMode() == AppleseedSession::ProgressiveRenderSession)
+    {
+        if (m_objectAssembly.get() == 0)
+            mainAssembly().objects().remove(m_curves.get());
+    }
+}
+
+void CurveExporter::createExporters(const AppleseedSession::Services& services)
+{
+    MIntArray perFaceAssignments;
+    createMaterialMappings(
+        dagPath(),
+        services,
+        m_frontMaterialMappings,
+        m_backMaterialMappings,
+        perFaceAssignments);
+
+    if (m_frontMaterialMappings.empty())
+    {
+        RENDERER_LOG_WARNING(
+            "Found curves %s with no materials.",
+            appleseedName().asChar());
+    }
+}
+
+void CurveExporter::createEntities(
+    const AppleseedSession::Options&            options,
+    const AppleseedSession::MotionBlurTimes&    motionBlurTimes)
+{
+    if (motionBlurTimes.m_deformTimes.size() > 1 && isAnimated(node()))
+    {
+        RENDERER_LOG_WARNING(
+            "Curves %s are deforming, but curve objects have no deformation keys. "
+            "Exporting them without deformation motion blur.",
+            appleseedName().asChar());
+    }
+
+    Strands strands;
+    if (dagPath().hasFn(MFn::kNurbsCurve))
+        readNurbsCurve(dagPath(), strands);
+    else
+        readPfxHair(dagPath(), strands);
+
+    std::vector<CurveVector> chunks;
+    convertStrands(strands, chunks);
+
+    size_t numCurves = 0;
+    for (size_t i = 0, e = chunks.size(); i < e; ++i)
+        numCurves += chunks[i].size();
+
+    asr::ParamArray params;
+    shapeAttributesToParams(params);
+
+    m_curves.reset(asr::CurveObjectFactory::create(appleseedName().asChar(), params));
+    m_curves->reserve_curves3(numCurves);
+
+    for (size_t i = 0, e = chunks.size(); i < e; ++i)
+    {
+        for (size_t j = 0, je = chunks[i].size(); j < je; ++j)
+            m_curves->push_curve3(chunks[i][j]);
+
+        CurveVector().swap(chunks[i]);
+    }
+
+    RENDERER_LOG_DEBUG(
+        "Exported %u curve segments for %u strands of %s",
+        static_cast<unsigned int>(numCurves),
+        static_cast<unsigned int>(strands.size()),
+        appleseedName().asChar());
+}
+
+void CurveExporter::flushEntities()
+{
+    ShapeExporter::flushEntities();
+
+    if (sessionMode() == AppleseedSession::ExportSession)
+        exportCurveFile();
+
+    RENDERER_LOG_DEBUG("Flushing curve object %s", m_curves->get_name());
+    if (m_objectAssembly.get())
+        m_objectAssembly->objects().insert(m_curves.releaseAs<asr::Object>());
+    else
+        mainAssembly().objects().insert(m_curves.releaseAs<asr::Object>());
+
+    createObjectInstance(objectName());
+}
+
+void CurveExporter::exportCurveFile()
+{
+    MurmurHash curvesHash;
+    curvesHash.append(m_curves->get_curve3_count());
+    for (size_t i = 0, e = m_curves->get_curve3_count(); i < e; ++i)
+        curvesHash.append(m_curves->get_curve3(i));
+
+    const std::string fileName = std::string("_geometry/") + curvesHash.toString() + ".binarycurve";
+
+    bfs::path projectPath = project().search_paths().get_root_path().c_str();
+    bfs::path p = projectPath / fileName;
+
+    // Write a curve file for the object if needed.
+    if (!bfs::exists(p))
+    {
+        if (!asr::CurveObjectWriter::write(*m_curves, p.string().c_str()))
+        {
+            RENDERER_LOG_ERROR(
+                "Couldn't export curve file for object %s.",
+                m_curves->get_name());
+            return;
+        }
+    }
+
+    // Replace our CurveObject by one referencing the exported curves.
+    asr::ParamArray params = m_curves->get_parameters();
+    params.insert("filepath", fileName.c_str());
+    m_curves.reset(asr::CurveObjectFactory::create(m_curves->get_name(), params));
+}
@@ -0,0 +1,90 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_MAYA_EXPORTERS_CURVEEXPORTER_H
+#define APPLESEED_MAYA_EXPORTERS_CURVEEXPORTER_H
+
+// appleseed.renderer headers.
+#include "renderer/api/object.h"
+#include "renderer/api/scene.h"
+
+// appleseed.maya headers.
+#include "appleseedmaya/exporters/shapeexporter.h"
+
+// Forward declarations.
+namespace renderer { class Project; }
+
+//
+// Exporter for NURBS curves tagged for rendering and Paint Effects hair.
+// Curves are exported as appleseed curve objects made of cubic Bezier segments.
+// The curve objects have no deformation keys: curves get transform motion blur,
+// but deforming curves are exported with their shape at the frame time only.
+//
+
+class CurveExporter
+  : public ShapeExporter
+{
+  public:
+
+    static void registerExporter();
+
+    // NURBS curves are only exported when their asRenderCurve attribute is set.
+    static DagNodeExporter* createNurbsCurve(
+      const MDagPath&                               path,
+      renderer::Project&                            project,
+      AppleseedSession::SessionMode                 sessionMode);
+
+    static DagNodeExporter* createPfxHair(
+      const MDagPath&                               path,
+      renderer::Project&                            project,
+      AppleseedSession::SessionMode                 sessionMode);
+
+    ~CurveExporter();
+
+    virtual void createExporters(const AppleseedSession::Services& services);
+
+    virtual void createEntities(
+        const AppleseedSession::Options&            options,
+        const AppleseedSession::MotionBlurTimes&    motionBlurTimes);
+
+    virtual void flushEntities();
+
+  private:
+
+    CurveExporter(
+      const MDagPath&                               path,
+      renderer::Project&                            project,
+      AppleseedSession::SessionMode                 sessionMode);
+
+    // Write the curves to a binary curve file and reference it.
+    void exportCurveFile();
+
+    AppleseedEntityPtr<renderer::CurveObject>       m_curves;
+};
+
+#endif  // !APPLESEED_MAYA_EXPORTERS_CURVEEXPORTER_H
@@ -42,10 +42,27 @@
 
 // appleseed.maya headers.
 #include "appleseedmaya/attributeutils.h"
+#include "appleseedmaya/transformcache.h"
 
 namespace asf = foundation;
 namespace asr = renderer;
 
+namespace
+{
+
+const AttributeUtils::CachedAttribute g_template("template");
+const AttributeUtils::CachedAttribute g_visibility("visibility");
+const AttributeUtils::CachedAttribute g_overrideVisibility("overrideVisibility");
+
+const AttributeUtils::CachedAttribute g_asVisibilityCamera("asVisibilityCamera");
+const AttributeUtils::CachedAttribute g_asVisibilityLight("asVisibilityLight");
+const AttributeUtils::CachedAttribute g_asVisibilityShadow("asVisibilityShadow");
+const AttributeUtils::CachedAttribute g_asVisibilityDiffuse("asVisibilityDiffuse");
+const AttributeUtils::CachedAttribute g_asVisibilitySpecular("asVisibilitySpecular");
+const AttributeUtils::CachedAttribute g_asVisibilityGlossy("asVisibilityGlossy");
+
+}
+
 DagNodeExporter::DagNodeExporter(
     const MDagPath&                 path,
     asr::Project&                   project,
@@ -54,7 +71,7 @@ DagNodeExporter::DagNodeExporter(
   , m_sessionMode(sessionMode)
   , m_project(project)
   , m_scene(*project.get_scene())
-  , m_mainAssembly(*m_scene.assemblies().get_by_name("assembly"))
+  , m_assembly(m_scene.assemblies().get_by_name("assembly"))
 {
 }
 
@@ -84,7 +101,13 @@ asr::Scene& DagNodeExporter::scene()
 
 asr::Assembly& DagNodeExporter::mainAssembly()
 {
-    return m_mainAssembly;
+    return *m_assembly;
+}
+
+void DagNodeExporter::setParentAssembly(asr::Assembly& assembly, const MDagPath& assemblyPath)
+{
+    m_assembly = &assembly;
+    m_assemblyPath = assemblyPath;
 }
 
 void DagNodeExporter::createExporters(const AppleseedSession::Services& services)
@@ -96,15 +119,15 @@ bool DagNodeExporter::supportsMotionBlur() const
     return true;
 }
 
-void DagNodeExporter::collectMotionBlurSteps(MotionBlurTimes& motionTimes) const
+void DagNodeExporter::collectMotionBlurSteps(AppleseedSession::MotionBlurTimes& motionTimes) const
 {
 }
 
-void DagNodeExporter::exportCameraMotionStep(float time)
+void DagNodeExporter::exportCameraMotionStep(float time, TransformCache& transformCache)
 {
 }
 
-void DagNodeExporter::exportTransformMotionStep(float time)
+void DagNodeExporter::exportTransformMotionStep(float time, TransformCache& transformCache)
 {
 }
 
@@ -112,6 +135,11 @@ void DagNodeExporter::exportShapeMotionStep(float time)
 {
 }
 
+bool DagNodeExporter::needsShapeMotionSteps() const
+{
+    return false;
+}
+
 MString DagNodeExporter::appleseedName() const
 {
     return dagPath().fullPathName();
@@ -135,32 +163,51 @@ asf::Matrix4d DagNodeExporter::convert(const MMatrix& m) const
     return result;
 }
 
+MMatrix DagNodeExporter::assemblyMatrix() const
+{
+    MMatrix m = dagPath().inclusiveMatrix();
+
+    if (m_assemblyPath.isValid())
+        m *= m_assemblyPath.inclusiveMatrixInverse();
+
+    return m;
+}
+
+asf::Transformd DagNodeExporter::assemblyTransform(TransformCache& transformCache) const
+{
+    if (m_assemblyPath.isValid())
+        return transformCache.relativeTransform(dagPath(), m_assemblyPath);
+
+    return transformCache.worldTransform(dagPath());
+}
+
 void DagNodeExporter::visibilityAttributesToParams(asr::ParamArray& params)
 {
     asf::Dictionary visFlags;
+    MFnDependencyNode depNodeFn(node());
 
     bool flag = true;
-    if(AttributeUtils::get(node(), "asVisibilityCamera", flag))
+    if(AttributeUtils::get(depNodeFn, g_asVisibilityCamera, flag))
         visFlags.insert("camera", flag);
 
     flag = true;
-    if (AttributeUtils::get(node(), "asVisibilityLight", flag))
+    if (AttributeUtils::get(depNodeFn, g_asVisibilityLight, flag))
         visFlags.insert("light", flag);
 
     flag = true;
-    if (AttributeUtils::get(node(), "asVisibilityShadow", flag))
+    if (AttributeUtils::get(depNodeFn, g_asVisibilityShadow, flag))
         visFlags.insert("shadow", flag);
 
     flag = true;
-    if (AttributeUtils::get(node(), "asVisibilityDiffuse", flag))
+    if (AttributeUtils::get(depNodeFn, g_asVisibilityDiffuse, flag))
         visFlags.insert("diffuse", flag);
 
     flag = true;
-    if (AttributeUtils::get(node(), "asVisibilitySpecular", flag))
+    if (AttributeUtils::get(depNodeFn, g_asVisibilitySpecular, flag))
         visFlags.insert("specular", flag);
 
     flag = true;
-    if (AttributeUtils::get(node(), "asVisibilityGlossy", flag))
+    if (AttributeUtils::get(depNodeFn, g_asVisibilityGlossy, flag))
         visFlags.insert("glossy", flag);
 
     params.insert("visibility", visFlags);
@@ -176,16 +223,16 @@ bool DagNodeExporter::isObjectRenderable(const MDagPath& path)
 
     // Skip templated objects.
     MStatus status;
-    MPlug plug = dagNodeFn.findPlug("template", false, &status);
+    MPlug plug = g_template.findPlug(dagNodeFn, &status);
     if (status == MS::kSuccess && plug.asBool())
         return false;
 
     // Skip invisible objects.
-    plug = dagNodeFn.findPlug("visibility", &status);
+    plug = g_visibility.findPlug(dagNodeFn, &status);
     if (status == MS::kSuccess && plug.asBool() == false)
         return false;
 
-    plug = dagNodeFn.findPlug("overrideVisibility", &status);
+    plug = g_overrideVisibility.findPlug(dagNodeFn, &status);
     if (status == MS::kSuccess && plug.asBool() == false)
         return false;
 
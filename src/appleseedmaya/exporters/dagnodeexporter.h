@@ -41,6 +41,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
 
 // appleseed.renderer headers.
 #include "renderer/api/utility.h"
@@ -50,10 +51,10 @@
 #include "appleseedmaya/utils.h"
 
 // Forward declarations.
+class TransformCache;
 namespace renderer { class Assembly; }
 namespace renderer { class Project; }
 namespace renderer { class Scene; }
-class MotionBlurTimes;
 
 class DagNodeExporter
   : public NonCopyable
@@ -66,6 +67,9 @@ class DagNodeExporter
     // Return the name of the entity in the appleseed project.
     MString appleseedName() const;
 
+    // Return the Maya dag path.
+    const MDagPath& dagPath() const;
+
     // Return true if the entity created by this exporter can be motion blurred.
     virtual bool supportsMotionBlur() const;
 
@@ -78,14 +82,27 @@ class DagNodeExporter
         const AppleseedSession::MotionBlurTimes&    motionBlurTimes) = 0;
 
     // Motion blur.
-    virtual void collectMotionBlurSteps(MotionBlurTimes& motionTimes) const;
-    virtual void exportCameraMotionStep(float time);
-    virtual void exportTransformMotionStep(float time);
+    virtual void collectMotionBlurSteps(AppleseedSession::MotionBlurTimes& motionTimes) const;
+    virtual void exportCameraMotionStep(float time, TransformCache& transformCache);
+    virtual void exportTransformMotionStep(float time, TransformCache& transformCache);
     virtual void exportShapeMotionStep(float time);
 
+    // Return true if the shape needs the scene to be evaluated at each deformation time.
+    virtual bool needsShapeMotionSteps() const;
+
     // Flush entities to the renderer.
     virtual void flushEntities() = 0;
 
+    // Export the entities into the assembly of a group instead of the main assembly.
+    // Transforms are then relative to the group.
+    void setParentAssembly(renderer::Assembly& assembly, const MDagPath& assemblyPath);
+
+    // Return true if the dag node is visible and not templated.
+    static bool isObjectRenderable(const MDagPath& path);
+
+    // Return true if the dag node and all its parents are renderable.
+    static bool areObjectAndParentsRenderable(const MDagPath& path);
+
   protected:
 
     DagNodeExporter(
@@ -96,9 +113,6 @@ class DagNodeExporter
     // Return the Maya dependency node.
     MObject node() const;
 
-    // Return the Maya dag path.
-    const MDagPath& dagPath() const;
-
     // Return the session mode.
     AppleseedSession::SessionMode sessionMode() const;
 
@@ -108,16 +122,19 @@ class DagNodeExporter
     // Return a reference to the appleseed scene.
     renderer::Scene& scene();
 
-    // Return a reference to the appleseed main assembly.
+    // Return a reference to the appleseed assembly the entities are exported to.
     renderer::Assembly& mainAssembly();
 
     // Convert a Maya matrix to an appleseed matrix.
     foundation::Matrix4d convert(const MMatrix& m) const;
 
-    void visibilityAttributesToParams(renderer::ParamArray& params);
+    // Return the matrix of the dag node relative to the assembly it is exported to.
+    MMatrix assemblyMatrix() const;
 
-    static bool isObjectRenderable(const MDagPath& path);
-    static bool areObjectAndParentsRenderable(const MDagPath& path);
+    // Return the transform of the dag node relative to the assembly it is exported to.
+    foundation::Transformd assemblyTransform(TransformCache& transformCache) const;
+
+    void visibilityAttributesToParams(renderer::ParamArray& params);
 
     static bool isAnimated(MObject object, bool checkParent=false);
 
@@ -127,7 +144,8 @@ class DagNodeExporter
     AppleseedSession::SessionMode m_sessionMode;
     renderer::Project&            m_project;
     renderer::Scene&              m_scene;
-    renderer::Assembly&           m_mainAssembly;
+    renderer::Assembly*           m_assembly;
+    MDagPath                      m_assemblyPath;
 };
 
 #endif  // !APPLESEED_MAYA_EXPORTERS_DAGNODEEXPORTER_H
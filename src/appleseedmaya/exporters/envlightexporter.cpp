@@ -41,6 +41,7 @@
 #include "appleseedmaya/exporters/exporterfactory.h"
 #include "appleseedmaya/physicalskylightnode.h"
 #include "appleseedmaya/skydomelightnode.h"
+#include "appleseedmaya/transformcache.h"
 
 namespace asf = foundation;
 namespace asr = renderer;
@@ -77,11 +78,9 @@ void EnvLightExporter::createEntities(
             appleseedName().asChar()));
 }
 
-void EnvLightExporter::exportTransformMotionStep(float time)
+void EnvLightExporter::exportTransformMotionStep(float time, TransformCache& transformCache)
 {
-    asf::Matrix4d m = convert(dagPath().inclusiveMatrix());
-    asf::Matrix4d invM = convert(dagPath().inclusiveMatrixInverse());
-    asf::Transformd xform(m, invM);
+    const asf::Transformd xform = transformCache.worldTransform(dagPath());
     m_envLight->transform_sequence().set_transform(time, xform);
 }
 
@@ -106,9 +105,6 @@ DagNodeExporter *PhysicalSkyLightExporter::create(
     asr::Project&                               project,
     AppleseedSession::SessionMode               sessionMode)
 {
-    if (areObjectAndParentsRenderable(path) == false)
-        return 0;
-
     return new PhysicalSkyLightExporter(path, project, sessionMode);
 }
 
@@ -191,9 +187,6 @@ DagNodeExporter *SkyDomeLightExporter::create(
     asr::Project&                               project,
     AppleseedSession::SessionMode               sessionMode)
 {
-    if (areObjectAndParentsRenderable(path) == false)
-        return 0;
-
     return new SkyDomeLightExporter(path, project, sessionMode);
 }
 
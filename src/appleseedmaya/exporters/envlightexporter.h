@@ -45,7 +45,7 @@ class EnvLightExporter
 
     ~EnvLightExporter();
 
-    virtual void exportTransformMotionStep(float time);
+    virtual void exportTransformMotionStep(float time, TransformCache& transformCache);
 
     virtual void flushEntities();
 
@@ -42,8 +42,11 @@
 #include "appleseedmaya/exporters/alphamapexporter.h"
 #include "appleseedmaya/exporters/arealightexporter.h"
 #include "appleseedmaya/exporters/cameraexporter.h"
+#include "appleseedmaya/exporters/curveexporter.h"
 #include "appleseedmaya/exporters/envlightexporter.h"
 #include "appleseedmaya/exporters/fileexporter.h"
+#include "appleseedmaya/exporters/instanceexporter.h"
+#include "appleseedmaya/exporters/instancerexporter.h"
 #include "appleseedmaya/exporters/lightexporter.h"
 #include "appleseedmaya/exporters/mandelbrotexporter.h"
 #include "appleseedmaya/exporters/meshexporter.h"
@@ -67,14 +70,25 @@ namespace asr = renderer;
 namespace
 {
 
+struct DagNodeExporterInfo
+{
+    NodeExporterFactory::CreateDagNodeExporterFn    m_createFn;
+    bool                                            m_exportHidden;
+};
+
 typedef std::map<
     MString,
-    NodeExporterFactory::CreateDagNodeExporterFn,
+    DagNodeExporterInfo,
     MStringCompareLess
     > CreateDagExporterMapType;
 
 CreateDagExporterMapType            gDagNodeExporters;
 
+// Dag node exporters by node type id, resolved from the type names on first use.
+typedef std::map<unsigned int, const DagNodeExporterInfo*> DagExporterTypeIdMapType;
+
+DagExporterTypeIdMapType            gDagNodeExportersByTypeId;
+
 typedef std::map<
     MString,
     NodeExporterFactory::CreateShadingNodeExporterFn,
@@ -89,6 +103,8 @@ MStatus NodeExporterFactory::initialize(const MString& pluginPath)
 {
     AreaLightExporter::registerExporter();
     CameraExporter::registerExporter();
+    CurveExporter::registerExporter();
+    InstancerExporter::registerExporter();
     LightExporter::registerExporter();
     MeshExporter::registerExporter();
     PhysicalSkyLightExporter::registerExporter();
@@ -114,16 +130,21 @@ MStatus NodeExporterFactory::initialize(const MString& pluginPath)
 
 MStatus NodeExporterFactory::uninitialize()
 {
+    gDagNodeExportersByTypeId.clear();
     return MS::kSuccess;
 }
 
 void NodeExporterFactory::registerDagNodeExporter(
     const MString&                  mayaTypeName,
-    CreateDagNodeExporterFn         createFn)
+    CreateDagNodeExporterFn         createFn,
+    const bool                      exportHidden)
 {
     assert(createFn != 0);
 
-    gDagNodeExporters[mayaTypeName] = createFn;
+    DagNodeExporterInfo& info = gDagNodeExporters[mayaTypeName];
+    info.m_createFn = createFn;
+    info.m_exportHidden = exportHidden;
+    gDagNodeExportersByTypeId.clear();
 
     /*
     RENDERER_LOG_DEBUG(
@@ -135,15 +156,36 @@ void NodeExporterFactory::registerDagNodeExporter(
 DagNodeExporter* NodeExporterFactory::createDagNodeExporter(
     const MDagPath&                 path,
     asr::Project&                   project,
-    AppleseedSession::SessionMode   sessionMode)
+    AppleseedSession::SessionMode   sessionMode,
+    const bool                      isRenderable)
 {
-    MFnDagNode dagNodeFn(path);
-    CreateDagExporterMapType::const_iterator it = gDagNodeExporters.find(dagNodeFn.typeName());
-
-    if (it == gDagNodeExporters.end())
+    MFnDependencyNode depNodeFn(path.node());
+    const unsigned int typeId = depNodeFn.typeId().id();
+
+    DagExporterTypeIdMapType::const_iterator it = gDagNodeExportersByTypeId.find(typeId);
+    if (it == gDagNodeExportersByTypeId.end())
+    {
+        CreateDagExporterMapType::const_iterator jt = gDagNodeExporters.find(depNodeFn.typeName());
+        const DagNodeExporterInfo* info = jt != gDagNodeExporters.end() ? &jt->second : 0;
+        it = gDagNodeExportersByTypeId.insert(std::make_pair(typeId, info)).first;
+    }
+
+    if (it->second == 0)
         throw NoExporterForNode();
 
-    return it->second(path, project, sessionMode);
+    if (!isRenderable && !it->second->m_exportHidden)
+        return 0;
+
+    return it->second->m_createFn(path, project, sessionMode);
+}
+
+DagNodeExporter* NodeExporterFactory::createInstanceExporter(
+    const MDagPath&                 path,
+    asr::Project&                   project,
+    AppleseedSession::SessionMode   sessionMode,
+    const ShapeExporter&            master)
+{
+    return InstanceExporter::create(path, project, sessionMode, master);
 }
 
 ShadingEngineExporter* NodeExporterFactory::createShadingEngineExporter(
@@ -159,6 +201,7 @@ ShadingNetworkExporter* NodeExporterFactory::createShadingNetworkExporter(
     const MObject&                  object,
     const MPlug&                    outputPlug,
     renderer::Assembly&             mainAssembly,
+    UniqueNameAllocator&            nameAllocator,
     AppleseedSession::SessionMode   sessionMode)
 {
     return new ShadingNetworkExporter(
@@ -166,6 +209,7 @@ ShadingNetworkExporter* NodeExporterFactory::createShadingNetworkExporter(
         object,
         outputPlug,
         mainAssembly,
+        nameAllocator,
         sessionMode);
 }
 
@@ -45,6 +45,8 @@
 #include "appleseedmaya/exporters/shadingnodeexporterfwd.h"
 
 // Forward declarations.
+class ShapeExporter;
+class UniqueNameAllocator;
 namespace renderer { class Assembly; }
 namespace renderer { class Project; }
 namespace renderer { class ShaderGroup; }
@@ -61,14 +63,26 @@ class NodeExporterFactory
         renderer::Project&,
         AppleseedSession::SessionMode);
 
+    // Exporters for node types that are exported even when hidden
+    // (cameras, ...) are registered with exportHidden set to true.
     static void registerDagNodeExporter(
         const MString&                  mayaTypeName,
-        CreateDagNodeExporterFn         createFn);
+        CreateDagNodeExporterFn         createFn,
+        const bool                      exportHidden = false);
 
+    // Create an exporter for a dag node, given its inherited renderability.
+    // Returns 0 for hidden nodes whose exporter only exports renderable nodes.
     static DagNodeExporter* createDagNodeExporter(
         const MDagPath&                 path,
         renderer::Project&              project,
-        AppleseedSession::SessionMode   sessionMode);
+        AppleseedSession::SessionMode   sessionMode,
+        const bool                      isRenderable);
+
+    static DagNodeExporter* createInstanceExporter(
+        const MDagPath&                 path,
+        renderer::Project&              project,
+        AppleseedSession::SessionMode   sessionMode,
+        const ShapeExporter&            master);
 
     static ShadingEngineExporter* createShadingEngineExporter(
         const MObject&                  object,
@@ -80,6 +94,7 @@ class NodeExporterFactory
         const MObject&                  object,
         const MPlug&                    outputPlug,
         renderer::Assembly&             mainAssembly,
+        UniqueNameAllocator&            nameAllocator,
         AppleseedSession::SessionMode   sessionMode);
 
     typedef ShadingNodeExporter* (*CreateShadingNodeExporterFn)(
@@ -42,6 +42,7 @@
 #include "appleseedmaya/attributeutils.h"
 #include "appleseedmaya/exporters/exporterfactory.h"
 #include "appleseedmaya/shadingnodemetadata.h"
+#include "appleseedmaya/textureconverter.h"
 
 namespace asf = foundation;
 namespace asr = renderer;
@@ -78,7 +79,8 @@ void FileExporter::exportParameterValue(
         const MString textureFileName =
             MRenderUtil::exactFileTextureName(node(), &status);
 
-        const MString value = MString("string ") + textureFileName;
+        const MString value =
+            MString("string ") + TextureConverter::convertTexture(textureFileName);
         shaderParams.insert("in_fileTextureName", value.asChar());
         return;
     }
@@ -29,41 +29,110 @@
 // Interface header.
 #include "appleseedmaya/exporters/instanceexporter.h"
 
-// Standard headers.
-#include <iostream>
+// Maya headers.
+#include <maya/MIntArray.h>
+
+// appleseed.renderer headers.
+#include "renderer/api/scene.h"
 
 // appleseed.maya headers.
-#include "appleseedmaya/appleseedsession.h"
+#include "appleseedmaya/logger.h"
 
 namespace asf = foundation;
 namespace asr = renderer;
 
+DagNodeExporter* InstanceExporter::create(
+    const MDagPath&                             path,
+    asr::Project&                               project,
+    AppleseedSession::SessionMode               sessionMode,
+    const ShapeExporter&                        master)
+{
+    return new InstanceExporter(path, project, sessionMode, master);
+}
+
 InstanceExporter::InstanceExporter(
-    const MDagPath&                 path,
-    AppleseedSession::SessionMode   sessionMode,
-    const ShapeExporter&            master,
-    asr::Project&                   project,
-    const asr::TransformSequence&   transformSequence)
+    const MDagPath&                             path,
+    asr::Project&                               project,
+    AppleseedSession::SessionMode               sessionMode,
+    const ShapeExporter&                        master)
   : ShapeExporter(path, project, sessionMode)
-  , m_masterShapeName(master.appleseedName())
+  , m_master(master)
 {
-    m_transformSequence = transformSequence;
     master.instanceCreated();
 }
 
+void InstanceExporter::createExporters(const AppleseedSession::Services& services)
+{
+    // Per-face assignments are part of the master geometry and
+    // match ours, instances can only change which material each slot uses.
+    MIntArray perFaceAssignments;
+    m_master.createMaterialMappings(
+        dagPath(),
+        services,
+        m_frontMaterialMappings,
+        m_backMaterialMappings,
+        perFaceAssignments);
+}
+
+void InstanceExporter::createEntities(
+    const AppleseedSession::Options&            options,
+    const AppleseedSession::MotionBlurTimes&    motionBlurTimes)
+{
+}
+
 void InstanceExporter::flushEntities()
 {
-    const MString assemblyName = m_masterShapeName + MString("_assembly");
-    const MString assemblyInstanceName = appleseedName() + MString("_instance");
+    m_transformSequence.optimize();
 
     asr::ParamArray params;
     visibilityAttributesToParams(params);
-    asf::auto_release_ptr<asr::AssemblyInstance> assemblyInstance(
+
+    MurmurHash masterMaterialsHash;
+    masterMaterialsHash.append(m_master.frontMaterialMappings());
+    masterMaterialsHash.append(m_master.backMaterialMappings());
+
+    MurmurHash materialsHash;
+    materialsHash.append(m_frontMaterialMappings);
+    materialsHash.append(m_backMaterialMappings);
+
+    MString assemblyName;
+
+    if (materialsHash == masterMaterialsHash)
+    {
+        // Same materials as the master, reuse its assembly.
+        assemblyName = m_master.appleseedName() + MString("_assembly");
+    }
+    else
+    {
+        // Different materials, create an assembly with our own object instance.
+        // The object itself lives in the main assembly and is found by name.
+        assemblyName = appleseedName() + MString("_assembly");
+        m_objectAssembly.reset(
+            asr::AssemblyFactory().create(assemblyName.asChar(), asr::ParamArray()));
+
+        const MString objectInstanceName = appleseedName() + MString("_instance");
+        m_objectInstance.reset(
+            asr::ObjectInstanceFactory::create(
+                objectInstanceName.asChar(),
+                asr::ParamArray(),
+                m_master.objectName().asChar(),
+                asf::Transformd::identity(),
+                m_frontMaterialMappings,
+                m_backMaterialMappings));
+
+        m_objectAssembly->object_instances().insert(m_objectInstance.release());
+        mainAssembly().assemblies().insert(m_objectAssembly.release());
+    }
+
+    RENDERER_LOG_DEBUG("Flushing instance of shape %s", m_master.appleseedName().asChar());
+
+    const MString assemblyInstanceName = appleseedName() + MString("_assembly_instance");
+    m_objectAssemblyInstance.reset(
         asr::AssemblyInstanceFactory::create(
             assemblyInstanceName.asChar(),
             params,
             assemblyName.asChar()));
 
-    assemblyInstance->transform_sequence() = m_transformSequence;
-    mainAssembly().assembly_instances().insert(assemblyInstance);
+    m_objectAssemblyInstance->transform_sequence() = m_transformSequence;
+    mainAssembly().assembly_instances().insert(m_objectAssemblyInstance.release());
 }
@@ -29,35 +29,49 @@
 #ifndef APPLESEED_MAYA_EXPORTERS_INSTANCEEXPORTER_H
 #define APPLESEED_MAYA_EXPORTERS_INSTANCEEXPORTER_H
 
-// Standard headers.
-#include<string>
+// appleseed.renderer headers.
+#include "renderer/api/scene.h"
 
 // appleseed.maya headers.
 #include "appleseedmaya/exporters/shapeexporter.h"
 
-// appleseed.renderer headers.
-#include "renderer/api/scene.h"
-
 // Forward declarations.
 namespace renderer { class Project; }
 
+//
+// Exporter for the extra dag paths of an instanced Maya shape.
+// The geometry is exported once by the master exporter;
+// instances only reference it.
+//
+
 class InstanceExporter
   : public ShapeExporter
 {
   public:
 
-    InstanceExporter(
-      const MDagPath&                     path,
-      AppleseedSession::SessionMode       sessionMode,
-      const ShapeExporter&                master,
-      renderer::Project&                  project,
-      const renderer::TransformSequence&  transformSequence);
+    static DagNodeExporter* create(
+      const MDagPath&                               path,
+      renderer::Project&                            project,
+      AppleseedSession::SessionMode                 sessionMode,
+      const ShapeExporter&                          master);
+
+    virtual void createExporters(const AppleseedSession::Services& services);
+
+    virtual void createEntities(
+        const AppleseedSession::Options&            options,
+        const AppleseedSession::MotionBlurTimes&    motionBlurTimes);
 
     virtual void flushEntities();
 
   private:
 
-    MString m_masterShapeName;
+    InstanceExporter(
+      const MDagPath&                               path,
+      renderer::Project&                            project,
+      AppleseedSession::SessionMode                 sessionMode,
+      const ShapeExporter&                          master);
+
+    const ShapeExporter&                            m_master;
 };
 
 #endif  // !APPLESEED_MAYA_EXPORTERS_INSTANCEEXPORTER_H
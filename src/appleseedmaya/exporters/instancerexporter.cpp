@@ -0,0 +1,391 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "appleseedmaya/exporters/instancerexporter.h"
+
+// Standard headers.
+#include <string>
+
+// Maya headers.
+#include <maya/MDoubleArray.h>
+#include <maya/MFnArrayAttrsData.h>
+#include <maya/MFnDependencyNode.h>
+#include <maya/MFnInstancer.h>
+#include <maya/MMatrix.h>
+#include <maya/MMatrixArray.h>
+#include <maya/MPlug.h>
+
+// appleseed.foundation headers.
+#include "foundation/utility/string.h"
+
+// appleseed.maya headers.
+#include "appleseedmaya/exceptions.h"
+#include "appleseedmaya/exporters/exporterfactory.h"
+#include "appleseedmaya/logger.h"
+#include "appleseedmaya/transformcache.h"
+
+namespace asf = foundation;
+namespace asr = renderer;
+
+namespace
+{
+
+// Read the ids of the particles driving an instancer, in instance order.
+bool getParticleIds(const MDagPath& path, MDoubleArray& ids)
+{
+    MStatus status;
+    MFnDependencyNode depNodeFn(path.node());
+    MPlug plug = depNodeFn.findPlug("inputPoints", &status);
+    if (!status)
+        return false;
+
+    MObject data;
+    if (!plug.getValue(data))
+        return false;
+
+    MFnArrayAttrsData arrayAttrsFn(data, &status);
+    if (!status)
+        return false;
+
+    MFnArrayAttrsData::Type type;
+    if (!arrayAttrsFn.checkArrayExist("id", type) || type != MFnArrayAttrsData::kDoubleArray)
+        return false;
+
+    ids = arrayAttrsFn.getDoubleData("id", &status);
+    return status == MS::kSuccess;
+}
+
+} // unnamed
+
+void InstancerExporter::registerExporter()
+{
+    NodeExporterFactory::registerDagNodeExporter("instancer", &InstancerExporter::create);
+}
+
+DagNodeExporter* InstancerExporter::create(
+    const MDagPath&                             path,
+    asr::Project&                               project,
+    AppleseedSession::SessionMode               sessionMode)
+{
+    return new InstancerExporter(path, project, sessionMode);
+}
+
+InstancerExporter::InstancerExporter(
+    const MDagPath&                             path,
+    asr::Project&                               project,
+    AppleseedSession::SessionMode               sessionMode)
+  : DagNodeExporter(path, project, sessionMode)
+  , m_flushed(false)
+  , m_numTransformSteps(0)
+{
+}
+
+InstancerExporter::~InstancerExporter()
+{
+    // The prototype exporters remove their entities from the prototype assemblies.
+    m_prototypeExporters.clear();
+
+    if (!m_flushed)
+    {
+        for (size_t i = 0, e = m_prototypeAssemblies.size(); i < e; ++i)
+            m_prototypeAssemblies[i]->release();
+    }
+    else if (sessionMode() == AppleseedSession::ProgressiveRenderSession)
+    {
+        for (size_t i = 0, e = m_assemblyInstances.size(); i < e; ++i)
+            mainAssembly().assembly_instances().remove(m_assemblyInstances[i]);
+
+        for (size_t i = 0, e = m_prototypeAssemblies.size(); i < e; ++i)
+            mainAssembly().assemblies().remove(m_prototypeAssemblies[i]);
+    }
+}
+
+void InstancerExporter::createExporters(const AppleseedSession::Services& services)
+{
+    MFnInstancer instancerFn(dagPath());
+
+    MMatrixArray matrices;
+    instancerFn.allInstances(
+        m_prototypePaths,
+        matrices,
+        m_pathStartIndices,
+        m_pathIndices);
+
+    // Each instanced dag path is exported once, relative to itself.
+    for (unsigned int i = 0, e = m_prototypePaths.length(); i < e; ++i)
+    {
+        asf::auto_release_ptr<asr::Assembly> assembly(
+            asr::AssemblyFactory().create(prototypeAssemblyName(i).asChar(), asr::ParamArray()));
+
+        createPrototypeExporters(m_prototypePaths[i], m_prototypePaths[i], *assembly);
+        m_prototypeAssemblies.push_back(assembly.release());
+    }
+
+    for (size_t i = 0, e = m_prototypeExporters.size(); i < e; ++i)
+        m_prototypeExporters[i]->createExporters(services);
+
+    // Particles are matched by id between motion steps.
+    MDoubleArray ids;
+    if (getParticleIds(dagPath(), ids) && ids.length() == matrices.length())
+    {
+        for (unsigned int i = 0, e = ids.length(); i < e; ++i)
+            m_particleIndices[static_cast<int>(ids[i])] = i;
+    }
+
+    // Instance transforms at the frame time, used for instances
+    // whose particle does not exist in every motion step.
+    const MMatrix toAssembly = dagPath().inclusiveMatrixInverse() * assemblyMatrix();
+    m_frameTransforms.resize(m_pathIndices.length());
+
+    for (unsigned int i = 0, e = matrices.length(); i < e; ++i)
+    {
+        const MMatrix instanceMatrix = matrices[i] * toAssembly;
+
+        for (int j = m_pathStartIndices[i], je = m_pathStartIndices[i + 1]; j < je; ++j)
+        {
+            const MMatrix pathMatrix = m_prototypePaths[m_pathIndices[j]].inclusiveMatrix();
+            m_frameTransforms[j] = asf::Transformd(convert(pathMatrix * instanceMatrix));
+        }
+    }
+
+    m_instanceTransforms.resize(m_pathIndices.length());
+
+    RENDERER_LOG_DEBUG(
+        "Instancer %s has %u prototypes and %u instances",
+        appleseedName().asChar(),
+        m_prototypePaths.length(),
+        m_pathIndices.length());
+}
+
+void InstancerExporter::createEntities(
+    const AppleseedSession::Options&            options,
+    const AppleseedSession::MotionBlurTimes&    motionBlurTimes)
+{
+    for (size_t i = 0, e = m_prototypeExporters.size(); i < e; ++i)
+        m_prototypeExporters[i]->createEntities(options, motionBlurTimes);
+}
+
+void InstancerExporter::exportTransformMotionStep(float time, TransformCache& transformCache)
+{
+    for (size_t i = 0, e = m_prototypeExporters.size(); i < e; ++i)
+        m_prototypeExporters[i]->exportTransformMotionStep(time, transformCache);
+
+    ++m_numTransformSteps;
+
+    if (m_pathIndices.length() == 0)
+        return;
+
+    MFnInstancer instancerFn(dagPath());
+
+    MDagPathArray paths;
+    MMatrixArray matrices;
+    MIntArray pathStartIndices;
+    MIntArray pathIndices;
+    instancerFn.allInstances(paths, matrices, pathStartIndices, pathIndices);
+
+    // Particles can be born or die between motion steps.
+    // Without particle ids, instances can only be matched by index.
+    MDoubleArray ids;
+    const bool matchIds =
+        !m_particleIndices.empty() &&
+        getParticleIds(dagPath(), ids) &&
+        ids.length() == matrices.length();
+
+    if (!matchIds && matrices.length() != m_pathStartIndices.length() - 1)
+    {
+        RENDERER_LOG_WARNING(
+            "Instancer %s changes its particles at time %f, instances will not be motion blurred",
+            appleseedName().asChar(),
+            time);
+        return;
+    }
+
+    // Instance matrices are in world space; bring them to the assembly of the instancer.
+    const MMatrix toAssembly = dagPath().inclusiveMatrixInverse() * assemblyMatrix();
+
+    std::vector<MMatrix> pathMatrices(paths.length());
+    for (unsigned int i = 0, e = paths.length(); i < e; ++i)
+        pathMatrices[i] = paths[i].inclusiveMatrix();
+
+    for (unsigned int i = 0, e = matrices.length(); i < e; ++i)
+    {
+        unsigned int particle = i;
+
+        if (matchIds)
+        {
+            ParticleIndexMap::const_iterator it = m_particleIndices.find(static_cast<int>(ids[i]));
+
+            // Particle born after the frame time.
+            if (it == m_particleIndices.end())
+                continue;
+
+            particle = it->second;
+        }
+
+        const int first = m_pathStartIndices[particle];
+        const int count = m_pathStartIndices[particle + 1] - first;
+
+        if (pathStartIndices[i + 1] - pathStartIndices[i] != count)
+            continue;
+
+        const MMatrix instanceMatrix = matrices[i] * toAssembly;
+
+        for (int j = 0; j < count; ++j)
+        {
+            const int pathIndex = pathIndices[pathStartIndices[i] + j];
+
+            // The particle switched prototypes.
+            if (!(paths[pathIndex] == m_prototypePaths[m_pathIndices[first + j]]))
+                continue;
+
+            const asf::Matrix4d m = convert(pathMatrices[pathIndex] * instanceMatrix);
+            m_instanceTransforms[first + j].set_transform(time, asf::Transformd(m));
+        }
+    }
+}
+
+void InstancerExporter::exportShapeMotionStep(float time)
+{
+    for (size_t i = 0, e = m_prototypeExporters.size(); i < e; ++i)
+        m_prototypeExporters[i]->exportShapeMotionStep(time);
+}
+
+bool InstancerExporter::needsShapeMotionSteps() const
+{
+    for (size_t i = 0, e = m_prototypeExporters.size(); i < e; ++i)
+    {
+        if (m_prototypeExporters[i]->needsShapeMotionSteps())
+            return true;
+    }
+
+    return false;
+}
+
+void InstancerExporter::flushEntities()
+{
+    for (size_t i = 0, e = m_prototypeExporters.size(); i < e; ++i)
+        m_prototypeExporters[i]->flushEntities();
+
+    for (size_t i = 0, e = m_prototypeAssemblies.size(); i < e; ++i)
+    {
+        mainAssembly().assemblies().insert(
+            asf::auto_release_ptr<asr::Assembly>(m_prototypeAssemblies[i]));
+    }
+
+    m_flushed = true;
+
+    asr::ParamArray params;
+    visibilityAttributesToParams(params);
+
+    std::vector<MString> assemblyNames(m_prototypeAssemblies.size());
+    for (size_t i = 0, e = assemblyNames.size(); i < e; ++i)
+        assemblyNames[i] = prototypeAssemblyName(i);
+
+    const std::string baseName = appleseedName().asChar() + std::string("_instance_");
+    m_assemblyInstances.reserve(m_pathIndices.length());
+
+    for (unsigned int i = 0, e = m_pathIndices.length(); i < e; ++i)
+    {
+        const std::string assemblyInstanceName = baseName + asf::to_string(i);
+
+        asf::auto_release_ptr<asr::AssemblyInstance> assemblyInstance(
+            asr::AssemblyInstanceFactory::create(
+                assemblyInstanceName.c_str(),
+                params,
+                assemblyNames[m_pathIndices[i]].asChar()));
+
+        asr::TransformSequence& transformSequence = m_instanceTransforms[i];
+
+        // Instances missing motion steps get a single key at the frame time.
+        if (transformSequence.empty() || transformSequence.size() != m_numTransformSteps)
+        {
+            transformSequence.clear();
+            transformSequence.set_transform(0.0, m_frameTransforms[i]);
+        }
+
+        transformSequence.optimize();
+        assemblyInstance->transform_sequence() = transformSequence;
+
+        m_assemblyInstances.push_back(assemblyInstance.get());
+        mainAssembly().assembly_instances().insert(assemblyInstance);
+    }
+
+    // Transform sequences are no longer needed.
+    TransformSequenceVector().swap(m_instanceTransforms);
+    TransformVector().swap(m_frameTransforms);
+    ParticleIndexMap().swap(m_particleIndices);
+}
+
+void InstancerExporter::createPrototypeExporters(
+    const MDagPath&                             path,
+    const MDagPath&                             prototypePath,
+    asr::Assembly&                              assembly)
+{
+    if (!path.hasFn(MFn::kTransform))
+    {
+        try
+        {
+            // Prototypes are usually hidden, export them anyway.
+            DagNodeExporterPtr exporter(
+                NodeExporterFactory::createDagNodeExporter(
+                    path,
+                    project(),
+                    sessionMode(),
+                    true));
+
+            ShapeExporterPtr shape = boost::dynamic_pointer_cast<ShapeExporter>(exporter);
+            if (shape)
+            {
+                shape->setParentAssembly(assembly, prototypePath);
+                m_prototypeExporters.push_back(shape);
+            }
+        }
+        catch (const NoExporterForNode&)
+        {
+        }
+    }
+
+    for (unsigned int i = 0, e = path.childCount(); i < e; ++i)
+    {
+        MDagPath childPath(path);
+        childPath.push(path.child(i));
+
+        if (DagNodeExporter::isObjectRenderable(childPath))
+            createPrototypeExporters(childPath, prototypePath, assembly);
+    }
+}
+
+MString InstancerExporter::prototypeAssemblyName(const size_t index) const
+{
+    MString name = appleseedName();
+    name += "_prototype_";
+    name += static_cast<unsigned int>(index);
+    name += "_assembly";
+    return name;
+}
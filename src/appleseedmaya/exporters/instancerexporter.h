@@ -0,0 +1,130 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_MAYA_EXPORTERS_INSTANCEREXPORTER_H
+#define APPLESEED_MAYA_EXPORTERS_INSTANCEREXPORTER_H
+
+// Standard headers.
+#include <map>
+#include <vector>
+
+// Maya headers.
+#include <maya/MDagPathArray.h>
+#include <maya/MIntArray.h>
+
+// appleseed.foundation headers.
+#include "foundation/math/transform.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/scene.h"
+#include "renderer/api/utility.h"
+
+// appleseed.maya headers.
+#include "appleseedmaya/exporters/dagnodeexporter.h"
+#include "appleseedmaya/exporters/shapeexporter.h"
+
+// Forward declarations.
+namespace renderer { class Project; }
+
+//
+// Exporter for Maya particle instancers.
+// Each instanced dag path is exported once, into its own prototype assembly,
+// and every particle adds instances of the prototype assemblies it uses.
+//
+
+class InstancerExporter
+  : public DagNodeExporter
+{
+  public:
+
+    static void registerExporter();
+
+    static DagNodeExporter* create(
+      const MDagPath&                               path,
+      renderer::Project&                            project,
+      AppleseedSession::SessionMode                 sessionMode);
+
+    ~InstancerExporter();
+
+    virtual void createExporters(const AppleseedSession::Services& services);
+
+    virtual void createEntities(
+        const AppleseedSession::Options&            options,
+        const AppleseedSession::MotionBlurTimes&    motionBlurTimes);
+
+    virtual void exportTransformMotionStep(float time, TransformCache& transformCache);
+    virtual void exportShapeMotionStep(float time);
+
+    virtual bool needsShapeMotionSteps() const;
+
+    virtual void flushEntities();
+
+  private:
+
+    InstancerExporter(
+      const MDagPath&                               path,
+      renderer::Project&                            project,
+      AppleseedSession::SessionMode                 sessionMode);
+
+    // Create exporters for a dag path and its children,
+    // exporting into the prototype assembly.
+    void createPrototypeExporters(
+        const MDagPath&                             path,
+        const MDagPath&                             prototypePath,
+        renderer::Assembly&                         assembly);
+
+    MString prototypeAssemblyName(const size_t index) const;
+
+    typedef std::vector<renderer::TransformSequence>    TransformSequenceVector;
+    typedef std::vector<foundation::Transformd>         TransformVector;
+    typedef std::map<int, unsigned int>                 ParticleIndexMap;
+    typedef std::vector<renderer::Assembly*>            AssemblyVector;
+    typedef std::vector<renderer::AssemblyInstance*>    AssemblyInstanceVector;
+
+    // Instanced dag paths and the prototypes used by each particle, at the frame time.
+    MDagPathArray                                   m_prototypePaths;
+    MIntArray                                       m_pathStartIndices;
+    MIntArray                                       m_pathIndices;
+
+    // Particle index at the frame time, by particle id.
+    ParticleIndexMap                                m_particleIndices;
+
+    std::vector<ShapeExporterPtr>                   m_prototypeExporters;
+
+    // Prototype assemblies are owned by the exporter until they are flushed.
+    AssemblyVector                                  m_prototypeAssemblies;
+    bool                                            m_flushed;
+
+    // One transform sequence per particle and instanced dag path.
+    TransformSequenceVector                         m_instanceTransforms;
+    TransformVector                                 m_frameTransforms;
+    size_t                                          m_numTransformSteps;
+    AssemblyInstanceVector                          m_assemblyInstances;
+};
+
+#endif  // !APPLESEED_MAYA_EXPORTERS_INSTANCEREXPORTER_H
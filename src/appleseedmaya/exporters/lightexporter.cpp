@@ -44,10 +44,21 @@
 // appleseed.maya headers.
 #include "appleseedmaya/attributeutils.h"
 #include "appleseedmaya/exporters/exporterfactory.h"
+#include "appleseedmaya/murmurhash.h"
 
 namespace asf = foundation;
 namespace asr = renderer;
 
+namespace
+{
+
+const AttributeUtils::CachedAttribute g_intensity("intensity");
+const AttributeUtils::CachedAttribute g_color("color");
+const AttributeUtils::CachedAttribute g_coneAngle("coneAngle");
+const AttributeUtils::CachedAttribute g_penumbraAngle("penumbraAngle");
+
+}
+
 void LightExporter::registerExporter()
 {
     NodeExporterFactory::registerDagNodeExporter("directionalLight", &LightExporter::create);
@@ -60,9 +71,6 @@ DagNodeExporter *LightExporter::create(
     asr::Project&                               project,
     AppleseedSession::SessionMode               sessionMode)
 {
-    if (areObjectAndParentsRenderable(path) == false)
-        return 0;
-
     return new LightExporter(path, project, sessionMode);
 }
 
@@ -99,7 +107,7 @@ void LightExporter::createEntities(
     MFnDependencyNode depNodeFn(node());
 
     MStatus status;
-    MPlug plug = depNodeFn.findPlug("intensity", &status);
+    MPlug plug = g_intensity.findPlug(depNodeFn, &status);
     if (plug.isConnected())
     {
         // todo: add warning here...
@@ -108,7 +116,7 @@ void LightExporter::createEntities(
     float intensity = 1.0;
     AttributeUtils::get(plug, intensity);
 
-    plug = depNodeFn.findPlug("color", &status);
+    plug = g_color.findPlug(depNodeFn, &status);
     if (plug.isConnected())
     {
         // todo: add warning here...
@@ -121,6 +129,16 @@ void LightExporter::createEntities(
         AttributeUtils::get(plug, color);
         asr::ColorValueArray values(3, &color.r);
 
+        // Lights with the same color share the color entity.
+        if (sessionMode() != AppleseedSession::ProgressiveRenderSession)
+        {
+            MurmurHash hash;
+            hash.append(color.r);
+            hash.append(color.g);
+            hash.append(color.b);
+            colorName = MString("color_") + MString(hash.toString().c_str());
+        }
+
         asr::ParamArray params;
         params.insert("color_space", "linear_rgb");
         m_lightColor.reset(
@@ -146,11 +164,11 @@ void LightExporter::createEntities(
         lightParams.insert("intensity_multiplier", intensity);
 
         MAngle coneAngle(20.0f, MAngle::kDegrees);
-        AttributeUtils::get(node(), "coneAngle", coneAngle);
+        AttributeUtils::get(depNodeFn, g_coneAngle, coneAngle);
         lightParams.insert("inner_angle", coneAngle.asDegrees());
 
         MAngle penumbraAngle(5.0f, MAngle::kDegrees);
-        AttributeUtils::get(node(), "penumbraAngle", penumbraAngle);
+        AttributeUtils::get(depNodeFn, g_penumbraAngle, penumbraAngle);
         const float outerAngle = coneAngle.asDegrees() + 2.0 * penumbraAngle.asDegrees();
         lightParams.insert("outer_angle", outerAngle);
     }
@@ -163,17 +181,15 @@ void LightExporter::createEntities(
     }
 
     m_light = lightFactory->create(appleseedName().asChar(), lightParams);
-    asf::Matrix4d m = convert(dagPath().inclusiveMatrix());
-    asf::Matrix4d invM = convert(dagPath().inclusiveMatrixInverse());
-    asf::Transformd xform(m, invM);
-    m_light->set_transform(xform);
+    // Invert the forward matrix instead of asking Maya for the inverse.
+    m_light->set_transform(asf::Transformd(convert(assemblyMatrix())));
 }
 
 void LightExporter::flushEntities()
 {
     if (m_light.get())
     {
-        mainAssembly().colors().insert(m_lightColor.release());
+        insertSharedEntity(mainAssembly().colors(), m_lightColor);
         mainAssembly().lights().insert(m_light.release());
     }
 }
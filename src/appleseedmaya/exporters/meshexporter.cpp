@@ -30,6 +30,7 @@
 #include "appleseedmaya/exporters/meshexporter.h"
 
 // Standard headers.
+#include <algorithm>
 #include <sstream>
 
 // Boost headers.
@@ -38,13 +39,20 @@
 #include "boost/filesystem/path.hpp"
 
 // Maya headers.
+#include <maya/MColorArray.h>
 #include <maya/MFloatPointArray.h>
 #include <maya/MFnMesh.h>
+#include <maya/MFnMeshData.h>
 #include <maya/MItDependencyGraph.h>
 #include <maya/MItMeshPolygon.h>
+#include <maya/MMeshSmoothOptions.h>
 #include <maya/MPointArray.h>
+#include <maya/MTime.h>
 
 // appleseed.foundation headers.
+#include "foundation/core/exceptions/exception.h"
+#include "foundation/mesh/genericmeshfilewriter.h"
+#include "foundation/mesh/imeshwalker.h"
 #include "foundation/utility/string.h"
 
 // appleseed.maya headers.
@@ -52,6 +60,7 @@
 #include "appleseedmaya/exporters/alphamapexporter.h"
 #include "appleseedmaya/exporters/exporterfactory.h"
 #include "appleseedmaya/logger.h"
+#include "appleseedmaya/utils.h"
 
 namespace bfs = boost::filesystem;
 namespace asf = foundation;
@@ -61,6 +70,20 @@ namespace asr = renderer;
 namespace
 {
 
+const AttributeUtils::CachedAttribute g_asAlphaMap("asAlphaMap");
+const AttributeUtils::CachedAttribute g_displaySmoothMesh("displaySmoothMesh");
+const AttributeUtils::CachedAttribute g_useSmoothPreviewForRender("useSmoothPreviewForRender");
+const AttributeUtils::CachedAttribute g_smoothLevel("smoothLevel");
+const AttributeUtils::CachedAttribute g_renderSmoothLevel("renderSmoothLevel");
+const AttributeUtils::CachedAttribute g_asExportUVs("asExportUVs");
+const AttributeUtils::CachedAttribute g_asExportNormals("asExportNormals");
+const AttributeUtils::CachedAttribute g_asSmoothTangents("asSmoothTangents");
+const AttributeUtils::CachedAttribute g_referenceObject("referenceObject");
+const AttributeUtils::CachedAttribute g_asVelocityBlur("asVelocityBlur");
+const AttributeUtils::CachedAttribute g_asMediumPriority("asMediumPriority");
+const AttributeUtils::CachedAttribute g_asVelocityColorSet("asVelocityColorSet");
+const AttributeUtils::CachedAttribute g_asVelocityScale("asVelocityScale");
+
 void staticMeshObjectHash(const asr::MeshObject& mesh, MurmurHash& hash)
 {
     hash.append(mesh.get_tex_coords_count());
@@ -114,8 +137,331 @@ void meshObjectHash(
     hash.append(backMaterialMappings);
 }
 
+// Split mesh faces into appleseed triangles, matching
+// the uv and normal indices of the face vertices.
+class FaceTriangulator
+{
+  public:
+
+    FaceTriangulator(const bool exportUVs, const bool exportNormals)
+      : m_exportUVs(exportUVs)
+      , m_exportNormals(exportNormals)
+    {
+    }
+
+    void triangulate(
+        MItMeshPolygon&                         faceIt,
+        const int                               materialIndex,
+        std::vector<asr::Triangle>&             triangles)
+    {
+        MStatus status;
+
+        // Collect normal and uv indices for this face.
+        m_faceUVIndices.clear();
+        m_faceNormalIndices.clear();
+
+        faceIt.getVertices(m_faceVertexIndices);
+        for(size_t i = 0, e = m_faceVertexIndices.length(); i < e; ++i)
+        {
+            if (m_exportUVs)
+            {
+                int uvIndex;
+                status = faceIt.getUVIndex(i, uvIndex);
+                m_faceUVIndices.append(uvIndex);
+            }
+
+            if (m_exportNormals)
+            {
+                unsigned int normalIndex = faceIt.normalIndex(i, &status);
+                m_faceNormalIndices.append(normalIndex);
+            }
+        }
+
+        // Match the triangle indices to the face indices.
+        int numTris;
+        faceIt.numTriangles(numTris);
+        for(size_t i = 0; i < numTris; ++i)
+        {
+            m_trianglePoints.clear();
+            m_triangleVertexIndices.clear();
+            faceIt.getTriangle(i, m_trianglePoints, m_triangleVertexIndices);
+
+            int triangleVertexOffset[3] = {-1, -1, -1};
+            for(size_t j = 0, je = m_faceVertexIndices.length(); j < je; ++j)
+            {
+                if (m_faceVertexIndices[j] == m_triangleVertexIndices[0])
+                    triangleVertexOffset[0] = j;
+                else if (m_faceVertexIndices[j] == m_triangleVertexIndices[1])
+                    triangleVertexOffset[1] = j;
+                else if (m_faceVertexIndices[j] == m_triangleVertexIndices[2])
+                    triangleVertexOffset[2] = j;
+            }
+
+            asr::Triangle triangle(
+                m_faceVertexIndices[triangleVertexOffset[0]],
+                m_faceVertexIndices[triangleVertexOffset[1]],
+                m_faceVertexIndices[triangleVertexOffset[2]],
+                materialIndex);
+
+            if (m_exportUVs)
+            {
+                triangle.m_a0 = m_faceUVIndices[triangleVertexOffset[0]];
+                triangle.m_a1 = m_faceUVIndices[triangleVertexOffset[1]];
+                triangle.m_a2 = m_faceUVIndices[triangleVertexOffset[2]];
+            }
+
+            if (m_exportNormals)
+            {
+                triangle.m_n0 = m_faceNormalIndices[triangleVertexOffset[0]];
+                triangle.m_n1 = m_faceNormalIndices[triangleVertexOffset[1]];
+                triangle.m_n2 = m_faceNormalIndices[triangleVertexOffset[2]];
+            }
+
+            triangles.push_back(triangle);
+        }
+    }
+
+  private:
+
+    const bool  m_exportUVs;
+    const bool  m_exportNormals;
+    MIntArray   m_faceVertexIndices;
+    MIntArray   m_faceUVIndices;
+    MIntArray   m_faceNormalIndices;
+    MIntArray   m_triangleVertexIndices;
+    MPointArray m_trianglePoints;
+};
+
 } // unnamed.
 
+//
+// MeshExporter::MeshFileWalker.
+//
+
+// Feeds appleseed's mesh file writers directly from the Maya mesh buffers.
+// Faces are triangulated one at a time, as the writers walk them in order,
+// so that the memory used does not grow with the size of the mesh.
+// The mesh is hashed from the Maya polygons, which determine the triangles,
+// so that meshes already written are never triangulated.
+class MeshExporter::MeshFileWalker
+  : public asf::IMeshWalker
+{
+  public:
+
+    explicit MeshFileWalker(const MeshExporter& exporter)
+      : m_exporter(exporter)
+      , m_meshFn(exporter.meshObject())
+      , m_points(0)
+      , m_normals(0)
+      , m_faceIt(exporter.meshObject())
+      , m_triangulator(exporter.m_exportUVs, exporter.m_exportNormals)
+      , m_numTriangles(0)
+      , m_firstTriangle(0)
+    {
+        MStatus status;
+        m_points = m_meshFn.getRawPoints(&status);
+
+        if (exporter.m_exportNormals)
+            m_normals = m_meshFn.getRawNormals(&status);
+
+        if (!exporter.m_frontMaterialMappings.empty())
+        {
+            asf::StringDictionary::const_iterator it(exporter.m_frontMaterialMappings.begin());
+            asf::StringDictionary::const_iterator e(exporter.m_frontMaterialMappings.end());
+            for(;it != e; ++it)
+                m_materialSlots.push_back(it.key());
+        }
+        else
+            m_materialSlots.push_back("default");
+
+        // Count the triangles and hash the polygons in a single pass.
+        MIntArray faceVertexIndices;
+        for(; !m_faceIt.isDone(); m_faceIt.next())
+        {
+            Computation::checkpoint();
+
+            int numTris;
+            m_faceIt.numTriangles(numTris);
+            m_numTriangles += numTris;
+
+            m_faceIt.getVertices(faceVertexIndices);
+            m_polygonsHash.append(faceVertexIndices.length());
+
+            for(unsigned int i = 0, e = faceVertexIndices.length(); i < e; ++i)
+            {
+                m_polygonsHash.append(faceVertexIndices[i]);
+
+                if (exporter.m_exportUVs)
+                {
+                    int uvIndex = 0;
+                    m_faceIt.getUVIndex(i, uvIndex);
+                    m_polygonsHash.append(uvIndex);
+                }
+
+                if (exporter.m_exportNormals)
+                    m_polygonsHash.append(m_faceIt.normalIndex(i));
+            }
+
+            m_polygonsHash.append(exporter.faceMaterialIndex(m_faceIt.index()));
+        }
+
+        m_faceIt.reset();
+    }
+
+    // Hash the mesh as written by the mesh file writers.
+    void hash(MurmurHash& hash) const
+    {
+        hash.append(get_vertex_count());
+        for(size_t i = 0, e = get_vertex_count(); i < e; ++i)
+        {
+            Computation::checkpoint();
+            hash.append(get_vertex(i));
+        }
+
+        hash.append(get_vertex_normal_count());
+        for(size_t i = 0, e = get_vertex_normal_count(); i < e; ++i)
+        {
+            Computation::checkpoint();
+            hash.append(get_vertex_normal(i));
+        }
+
+        hash.append(get_tex_coords_count());
+        for(size_t i = 0, e = get_tex_coords_count(); i < e; ++i)
+            hash.append(get_tex_coords(i));
+
+        hash.append(get_material_slot_count());
+        for(size_t i = 0, e = get_material_slot_count(); i < e; ++i)
+            hash.append(get_material_slot(i));
+
+        hash.append(m_numTriangles);
+        hash.append(m_polygonsHash.toString());
+    }
+
+    virtual const char* get_name() const
+    {
+        return "mesh";
+    }
+
+    virtual size_t get_vertex_count() const
+    {
+        return m_meshFn.numVertices();
+    }
+
+    virtual asf::Vector3d get_vertex(const size_t i) const
+    {
+        return asf::Vector3d(m_exporter.vertexPosition(m_points + 3 * i, i));
+    }
+
+    virtual size_t get_vertex_normal_count() const
+    {
+        return m_normals ? m_meshFn.numNormals() : 0;
+    }
+
+    virtual asf::Vector3d get_vertex_normal(const size_t i) const
+    {
+        const float* p = m_normals + 3 * i;
+        const asr::GVector3 Y(0.0f, 1.0f, 0.0f);
+        return asf::Vector3d(asf::safe_normalize(asr::GVector3(p[0], p[1], p[2]), Y));
+    }
+
+    virtual size_t get_tex_coords_count() const
+    {
+        return m_exporter.m_exportUVs ? m_meshFn.numUVs() : 0;
+    }
+
+    virtual asf::Vector2d get_tex_coords(const size_t i) const
+    {
+        float u, v;
+        m_meshFn.getUV(static_cast<int>(i), u, v);
+        return asf::Vector2d(u, v);
+    }
+
+    virtual size_t get_material_slot_count() const
+    {
+        return m_materialSlots.size();
+    }
+
+    virtual const char* get_material_slot(const size_t i) const
+    {
+        return m_materialSlots[i].c_str();
+    }
+
+    virtual size_t get_face_count() const
+    {
+        return m_numTriangles;
+    }
+
+    virtual size_t get_face_vertex_count(const size_t face_index) const
+    {
+        return 3;
+    }
+
+    virtual size_t get_face_vertex(const size_t face_index, const size_t vertex_index) const
+    {
+        const asr::Triangle& t = triangle(face_index);
+        return vertex_index == 0 ? t.m_v0 : vertex_index == 1 ? t.m_v1 : t.m_v2;
+    }
+
+    virtual size_t get_face_vertex_normal(const size_t face_index, const size_t vertex_index) const
+    {
+        const asr::Triangle& t = triangle(face_index);
+        return vertex_index == 0 ? t.m_n0 : vertex_index == 1 ? t.m_n1 : t.m_n2;
+    }
+
+    virtual size_t get_face_tex_coords(const size_t face_index, const size_t vertex_index) const
+    {
+        const asr::Triangle& t = triangle(face_index);
+        return vertex_index == 0 ? t.m_a0 : vertex_index == 1 ? t.m_a1 : t.m_a2;
+    }
+
+    virtual size_t get_face_material(const size_t face_index) const
+    {
+        return triangle(face_index).m_pa;
+    }
+
+  private:
+
+    const asr::Triangle& triangle(const size_t index) const
+    {
+        assert(index < m_numTriangles);
+
+        // Faces are walked in order, restart from the first one otherwise.
+        if (index < m_firstTriangle)
+        {
+            m_faceIt.reset();
+            m_faceTriangles.clear();
+            m_firstTriangle = 0;
+        }
+
+        while (index >= m_firstTriangle + m_faceTriangles.size())
+        {
+            assert(!m_faceIt.isDone());
+
+            m_firstTriangle += m_faceTriangles.size();
+            m_faceTriangles.clear();
+            m_triangulator.triangulate(
+                m_faceIt,
+                m_exporter.faceMaterialIndex(m_faceIt.index()),
+                m_faceTriangles);
+            m_faceIt.next();
+        }
+
+        return m_faceTriangles[index - m_firstTriangle];
+    }
+
+    const MeshExporter&                 m_exporter;
+    MFnMesh                             m_meshFn;
+    const float*                        m_points;
+    const float*                        m_normals;
+    std::vector<std::string>            m_materialSlots;
+    mutable MItMeshPolygon              m_faceIt;
+    mutable FaceTriangulator            m_triangulator;
+    mutable std::vector<asr::Triangle>  m_faceTriangles;
+    size_t                              m_numTriangles;
+    MurmurHash                          m_polygonsHash;
+    mutable size_t                      m_firstTriangle;
+};
+
 void MeshExporter::registerExporter()
 {
     NodeExporterFactory::registerDagNodeExporter("mesh", &MeshExporter::create);
@@ -126,9 +472,6 @@ DagNodeExporter *MeshExporter::create(
     asr::Project&                               project,
     AppleseedSession::SessionMode               sessionMode)
 {
-    if (areObjectAndParentsRenderable(path) == false)
-        return 0;
-
     return new MeshExporter(path, project, sessionMode);
 }
 
@@ -137,6 +480,7 @@ MeshExporter::MeshExporter(
     asr::Project&                               project,
     AppleseedSession::SessionMode               sessionMode)
   : ShapeExporter(path, project, sessionMode)
+  , m_smoothLevel(0)
 {
 }
 
@@ -144,69 +488,96 @@ MeshExporter::~MeshExporter()
 {
     if (sessionMode() == AppleseedSession::ProgressiveRenderSession)
     {
-        if (m_objectAssembly.get() == 0)
+        if (m_objectAssembly.get() == 0 || m_numInstances != 0)
             mainAssembly().objects().remove(m_mesh.get());
     }
 }
 
-void MeshExporter::createExporters(const AppleseedSession::Services& services)
+bool MeshExporter::supportsInstancing() const
 {
-    const int instanceNumber = dagPath().isInstanced() ? dagPath().instanceNumber() : 0;
+    return true;
+}
 
-    MStatus status;
-    MFnDependencyNode depNodeFn(dagPath().node(), &status);
-    MPlug plug = depNodeFn.findPlug("instObjGroups");
-    plug = plug.elementByLogicalIndex(instanceNumber);
+bool MeshExporter::canInstance(const MDagPath& path) const
+{
+    MFnMesh fnMesh(path.node());
 
-    if (plug.isConnected())
-    {
-        // We have only one material for the mesh.
-        MPlugArray connections;
-        plug.connectedTo(connections, false, true);
-        MObject shadingEngine = connections[0].node();
-        services.createShadingEngineExporter(shadingEngine);
-        depNodeFn.setObject(shadingEngine);
-        MString materialName = depNodeFn.name() + MString("_material");
-        m_frontMaterialMappings.insert("default", materialName.asChar());
+    MObjectArray shadingEngines;
+    MIntArray masterAssignments;
+    fnMesh.getConnectedShaders(
+        dagPath().isInstanced() ? dagPath().instanceNumber() : 0,
+        shadingEngines,
+        masterAssignments);
 
-        bool doubleSided = false;
-        AttributeUtils::get(depNodeFn, "asDoubleSided", doubleSided);
-        if (doubleSided)
-            m_backMaterialMappings.insert("default", materialName.asChar());
-    }
-    else
+    MIntArray assignments;
+    fnMesh.getConnectedShaders(path.instanceNumber(), shadingEngines, assignments);
+
+    if (assignments.length() != masterAssignments.length())
+        return false;
+
+    for (unsigned int i = 0, e = assignments.length(); i < e; ++i)
     {
-        // The mesh has per-face materials.
-        MFnMesh fnMesh(dagPath().node());
-        MObjectArray shadingEngines;
-        fnMesh.getConnectedShaders(instanceNumber, shadingEngines, m_perFaceAssignments);
+        if (assignments[i] != masterAssignments[i])
+            return false;
+    }
 
-        for(size_t i = 0, e = shadingEngines.length(); i < e; ++i)
-        {
-            services.createShadingEngineExporter(shadingEngines[i]);
-            depNodeFn.setObject(shadingEngines[i]);
-            MString materialName = depNodeFn.name() + MString("_material");
+    return true;
+}
 
-            bool doubleSided = false;
-            AttributeUtils::get(depNodeFn, "asDoubleSided", doubleSided);
+MString MeshExporter::objectName() const
+{
+    if (sessionMode() == AppleseedSession::ExportSession)
+        return appleseedName() + MString(".mesh");
 
-            if (i == 0)
-            {
-                m_frontMaterialMappings.insert("default", materialName.asChar());
+    return appleseedName();
+}
 
-                if (doubleSided)
-                    m_backMaterialMappings.insert("default", materialName.asChar());
-            }
-            else
-            {
-                std::string slotName = asf::get_numbered_string("slot#", i);
-                m_frontMaterialMappings.insert(slotName.c_str(), materialName.asChar());
+void MeshExporter::createMaterialMappings(
+    const MDagPath&                             path,
+    const AppleseedSession::Services&           services,
+    asf::StringDictionary&                      frontMaterialMappings,
+    asf::StringDictionary&                      backMaterialMappings,
+    MIntArray&                                  perFaceAssignments) const
+{
+    ShapeExporter::createMaterialMappings(
+        path,
+        services,
+        frontMaterialMappings,
+        backMaterialMappings,
+        perFaceAssignments);
+
+    if (!frontMaterialMappings.empty())
+        return;
 
-                if (doubleSided)
-                    m_backMaterialMappings.insert(slotName.c_str(), materialName.asChar());
-            }
-        }
+    // The mesh has per-face materials.
+    const int instanceNumber = path.isInstanced() ? path.instanceNumber() : 0;
+
+    MFnMesh fnMesh(path.node());
+    MObjectArray shadingEngines;
+    fnMesh.getConnectedShaders(instanceNumber, shadingEngines, perFaceAssignments);
+
+    for(size_t i = 0, e = shadingEngines.length(); i < e; ++i)
+    {
+        const std::string slotName =
+            i == 0 ? std::string("default") : asf::get_numbered_string("slot#", i);
+
+        addMaterialMapping(
+            services,
+            shadingEngines[i],
+            slotName.c_str(),
+            frontMaterialMappings,
+            backMaterialMappings);
     }
+}
+
+void MeshExporter::createExporters(const AppleseedSession::Services& services)
+{
+    createMaterialMappings(
+        dagPath(),
+        services,
+        m_frontMaterialMappings,
+        m_backMaterialMappings,
+        m_perFaceAssignments);
 
     if (m_frontMaterialMappings.empty())
     {
@@ -216,8 +587,9 @@ void MeshExporter::createExporters(const AppleseedSession::Services& services)
     }
 
     // Create an alpha map exporter if needed.
-    depNodeFn.setObject(dagPath().node());
-    plug = depNodeFn.findPlug("asAlphaMap", &status);
+    MStatus status;
+    MFnDependencyNode depNodeFn(dagPath().node(), &status);
+    MPlug plug = g_asAlphaMap.findPlug(depNodeFn, &status);
 
     MPlugArray connections;
     plug.connectedTo(connections, true, false);
@@ -236,48 +608,80 @@ void MeshExporter::createEntities(
     shapeAttributesToParams(m_meshParams);
     meshAttributesToParams(m_meshParams);
 
+    MFnDependencyNode depNodeFn(node());
+
+    // Subdivide meshes displayed smooth in the viewport at export time.
+    m_smoothLevel = 0;
+    int displaySmoothMesh = 0;
+    AttributeUtils::get(depNodeFn, g_displaySmoothMesh, displaySmoothMesh);
+    if (displaySmoothMesh != 0)
+    {
+        bool useSmoothPreviewForRender = true;
+        AttributeUtils::get(depNodeFn, g_useSmoothPreviewForRender, useSmoothPreviewForRender);
+        AttributeUtils::get(
+            depNodeFn,
+            useSmoothPreviewForRender ? g_smoothLevel : g_renderSmoothLevel,
+            m_smoothLevel);
+    }
+
+    // Maya does not tell which cage face each smoothed face comes from,
+    // keep the per-face materials right by exporting the cage.
+    if (m_smoothLevel > 0 && m_perFaceAssignments.length() != 0)
+    {
+        RENDERER_LOG_WARNING(
+            "Smoothed mesh %s has per-face materials, exporting the cage instead.",
+            appleseedName().asChar());
+
+        m_smoothLevel = 0;
+    }
+
+    // The smoothed mesh is generated at each deformation time.
     MFnMesh meshFn(dagPath());
 
     m_exportUVs = meshFn.numUVs() != 0;
     if (m_exportUVs)
-        AttributeUtils::get(node(), "asExportUVs", m_exportUVs);
+        AttributeUtils::get(depNodeFn, g_asExportUVs, m_exportUVs);
 
     m_exportNormals = meshFn.numNormals() != 0;
     if (m_exportNormals)
-        AttributeUtils::get(node(), "asExportNormals", m_exportNormals);
+        AttributeUtils::get(depNodeFn, g_asExportNormals, m_exportNormals);
 
     m_smoothTangents = false;
     if (m_exportUVs)
-        AttributeUtils::get(node(), "asSmoothTangents", m_smoothTangents);
+        AttributeUtils::get(depNodeFn, g_asSmoothTangents, m_smoothTangents);
 
     MStatus status;
-    MPlug plug = meshFn.findPlug("referenceObject", &status);
+    MPlug plug = g_referenceObject.findPlug(depNodeFn, &status);
     m_exportReference = plug.isConnected();
 
     if (m_exportReference)
     {
         RENDERER_LOG_INFO(
             "Found reference geometry for mesh %s.",
-            m_mesh->get_name());
+            appleseedName().asChar());
 
         // We don't support PRef and NRef yet...
         m_exportReference = false;
     }
 
-    if (plug.isConnected())
-
     m_numMeshKeys = motionBlurTimes.m_deformTimes.size();
-    m_isDeforming = (m_numMeshKeys > 1) && isAnimated(node());
+    m_deformTimes.assign(
+        motionBlurTimes.m_deformTimes.begin(),
+        motionBlurTimes.m_deformTimes.end());
+
+    // Velocity blur builds all the deformation keys from the first one.
+    m_velocityBlur = false;
+    if (m_numMeshKeys > 1)
+        AttributeUtils::get(depNodeFn, g_asVelocityBlur, m_velocityBlur);
+
+    m_isDeforming = (m_numMeshKeys > 1) && !m_velocityBlur && isAnimated(node());
     m_shapeExportStep = 0;
+    m_keyTimeOffset = 0.0f;
+}
 
-    if (sessionMode() != AppleseedSession::ExportSession)
-    {
-        MString objectName = appleseedName();
-        m_mesh = asr::MeshObjectFactory::create(objectName.asChar(), m_meshParams);
-        createMaterialSlots();
-        fillTopology();
-        exportGeometry();
-    }
+bool MeshExporter::needsShapeMotionSteps() const
+{
+    return m_isDeforming;
 }
 
 void MeshExporter::exportShapeMotionStep(float time)
@@ -286,53 +690,27 @@ void MeshExporter::exportShapeMotionStep(float time)
     if (!m_isDeforming && m_shapeExportStep > 0)
         return;
 
+    if (m_smoothLevel > 0)
+        updateSmoothMesh();
+
     if (sessionMode() == AppleseedSession::ExportSession)
     {
-        MString objectName = appleseedName();
-        m_mesh = asr::MeshObjectFactory::create(objectName.asChar(), m_meshParams);
-        createMaterialSlots();
-        fillTopology();
-        exportGeometry();
-
-        // Compute smooth tangents if needed.
-        if (m_smoothTangents)
+        if (m_velocityBlur && m_shapeExportStep == 0)
         {
-            assert(m_exportUVs);
-            asr::compute_smooth_vertex_tangents(*m_mesh);
-        }
+            // Write all the deformation keys from the current evaluation.
+            readVelocities();
 
-        MurmurHash meshHash;
-        staticMeshObjectHash(*m_mesh, meshHash);
-
-//#define APPLESEED_MAYA_OBJ_MESH_EXPORT
-#ifdef APPLESEED_MAYA_OBJ_MESH_EXPORT
-        const char *extension = ".obj";
-#else
-        const char *extension = ".binarymesh";
-#endif
-        const std::string fileName = std::string("_geometry/") + meshHash.toString() + extension;
-
-        bfs::path projectPath = project().search_paths().get_root_path().c_str();
-        bfs::path p = projectPath / fileName;
-
-        // Write a geom file for the object if needed.
-        if (!bfs::exists(p))
-        {
-            if (!asr::MeshObjectWriter::write(*m_mesh, "mesh", p.string().c_str()))
+            const size_t numKeys = m_velocityBlur ? m_numMeshKeys : 1;
+            for(size_t i = 0; i < numKeys; ++i)
             {
-                RENDERER_LOG_ERROR(
-                    "Couldn't export mesh file for object %s.",
-                    m_mesh->get_name());
+                m_keyTimeOffset = m_deformTimes[i] - m_deformTimes[0];
+                exportMeshFile();
             }
+
+            m_keyTimeOffset = 0.0f;
         }
         else
-        {
-            RENDERER_LOG_INFO(
-                "Mesh file for object %s already exists.",
-                m_mesh->get_name());
-        }
-
-        m_fileNames.push_back(fileName);
+            exportMeshFile();
 
         if (m_exportReference && m_shapeExportStep == 0)
         {
@@ -346,9 +724,34 @@ void MeshExporter::exportShapeMotionStep(float time)
             // todo: export PRef and possibly NRef here.
         }
 
-        // We already exported the first mesh key when
-        // we exported the topology.
-        if (m_shapeExportStep > 0)
+        if (m_shapeExportStep == 0)
+        {
+            // The first key, and the velocities, are read at the first deformation time.
+            if (m_velocityBlur)
+                readVelocities();
+
+            MString objectName = appleseedName();
+            m_mesh = asr::MeshObjectFactory::create(objectName.asChar(), m_meshParams);
+            createMaterialSlots();
+            fillTopology();
+            exportGeometry();
+
+            if (m_isDeforming)
+                m_firstKeyHash = pointsHash(MFnMesh(meshObject()));
+
+            if (m_velocityBlur)
+            {
+                for(m_shapeExportStep = 1; m_shapeExportStep < m_numMeshKeys; ++m_shapeExportStep)
+                {
+                    m_keyTimeOffset = m_deformTimes[m_shapeExportStep] - m_deformTimes[0];
+                    exportMeshKey();
+                }
+
+                m_shapeExportStep = 0;
+                m_keyTimeOffset = 0.0f;
+            }
+        }
+        else
             exportMeshKey();
     }
 
@@ -359,14 +762,16 @@ void MeshExporter::flushEntities()
 {
     ShapeExporter::flushEntities();
 
-    MString objectName = appleseedName();
-
     if (sessionMode() == AppleseedSession::ExportSession)
     {
         assert(!m_fileNames.empty());
 
-        // Replace our MeshObject by one referencing the exported meshes.
-        asr::ParamArray params = m_mesh->get_parameters();
+        // If all the keys are identical, the mesh does not need motion blur.
+        if (static_cast<size_t>(std::count(m_fileNames.begin(), m_fileNames.end(), m_fileNames[0])) == m_fileNames.size())
+            m_fileNames.resize(1);
+
+        // Create a MeshObject referencing the exported meshes.
+        asr::ParamArray params = m_meshParams;
 
         if (m_fileNames.size() == 1)
             params.insert("filename", m_fileNames[0].c_str());
@@ -384,8 +789,7 @@ void MeshExporter::flushEntities()
             params.insert("filenames", fileNames);
         }
 
-        m_mesh.reset(asr::MeshObjectFactory().create(m_mesh->get_name(), params));
-        objectName += ".mesh";
+        m_mesh.reset(asr::MeshObjectFactory().create(appleseedName().asChar(), params));
     }
     else
     {
@@ -417,23 +821,154 @@ void MeshExporter::flushEntities()
     }
     */
 
+    // When the mesh is instanced, it lives in the main assembly so that
+    // the instance assemblies can reference it without duplicating it.
     RENDERER_LOG_DEBUG("Flushing mesh object %s", m_mesh->get_name());
-    if (m_objectAssembly.get())
+    if (m_objectAssembly.get() && m_numInstances == 0)
         m_objectAssembly->objects().insert(m_mesh.releaseAs<asr::Object>());
     else
         mainAssembly().objects().insert(m_mesh.releaseAs<asr::Object>());
 
     RENDERER_LOG_DEBUG("Flushing object instance %s", m_mesh->get_name());
-    createObjectInstance(objectName);
+    createObjectInstance(objectName());
 }
 
 void MeshExporter::meshAttributesToParams(renderer::ParamArray& params)
 {
     int mediumPriority = 0;
-    if (AttributeUtils::get(node(), "asMediumPriority", mediumPriority))
+    if (AttributeUtils::get(node(), g_asMediumPriority, mediumPriority))
         params.insert("medium_priority", mediumPriority);
 }
 
+void MeshExporter::exportMeshFile()
+{
+    // Mesh files are written straight from the Maya mesh, without building
+    // an appleseed mesh first. Tangents are not stored in mesh files.
+    const MeshFileWalker walker(*this);
+
+    MurmurHash meshHash;
+    walker.hash(meshHash);
+
+//#define APPLESEED_MAYA_OBJ_MESH_EXPORT
+#ifdef APPLESEED_MAYA_OBJ_MESH_EXPORT
+    const char *extension = ".obj";
+#else
+    const char *extension = ".binarymesh";
+#endif
+    const std::string fileName = std::string("_geometry/") + meshHash.toString() + extension;
+
+    bfs::path projectPath = project().search_paths().get_root_path().c_str();
+    bfs::path p = projectPath / fileName;
+
+    // The mesh writer can't be interrupted, check before starting it.
+    Computation::checkpoint();
+
+    // Write a geom file for the object if needed.
+    if (!bfs::exists(p))
+    {
+        try
+        {
+            asf::GenericMeshFileWriter writer(p.string().c_str());
+            writer.write(walker);
+        }
+        catch (const asf::Exception&)
+        {
+            RENDERER_LOG_ERROR(
+                "Couldn't export mesh file for object %s.",
+                appleseedName().asChar());
+        }
+    }
+    else
+    {
+        RENDERER_LOG_INFO(
+            "Mesh file for object %s already exists.",
+            appleseedName().asChar());
+    }
+
+    m_fileNames.push_back(fileName);
+}
+
+void MeshExporter::readVelocities()
+{
+    m_velocities.clear();
+
+    MString colorSetName("velocityPV");
+    AttributeUtils::get(node(), g_asVelocityColorSet, colorSetName);
+
+    float velocityScale = 1.0f;
+    AttributeUtils::get(node(), g_asVelocityScale, velocityScale);
+
+    MFnMesh meshFn(meshObject());
+    MColorArray velocities;
+    if (!meshFn.getVertexColors(velocities, &colorSetName) ||
+        velocities.length() != meshFn.numVertices())
+    {
+        RENDERER_LOG_WARNING(
+            "Couldn't read velocities from color set %s of mesh %s, disabling velocity blur.",
+            colorSetName.asChar(),
+            appleseedName().asChar());
+
+        m_velocityBlur = false;
+        return;
+    }
+
+    // Velocities are in units per second, deformation times in frames.
+    const float secondsPerFrame =
+        static_cast<float>(MTime(1.0, MTime::uiUnit()).as(MTime::kSeconds));
+    velocityScale *= secondsPerFrame;
+
+    m_velocities.reserve(velocities.length());
+    for(size_t i = 0, e = velocities.length(); i < e; ++i)
+    {
+        m_velocities.push_back(
+            asr::GVector3(velocities[i].r, velocities[i].g, velocities[i].b) * velocityScale);
+    }
+}
+
+asr::GVector3 MeshExporter::vertexPosition(const float* p, const size_t index) const
+{
+    asr::GVector3 v(p[0], p[1], p[2]);
+
+    if (m_velocityBlur && m_keyTimeOffset != 0.0f)
+        v += m_velocities[index] * m_keyTimeOffset;
+
+    return v;
+}
+
+MObject MeshExporter::meshObject() const
+{
+    if (!m_smoothMesh.isNull())
+        return m_smoothMesh;
+
+    return dagPath().node();
+}
+
+void MeshExporter::updateSmoothMesh()
+{
+    MStatus status;
+    MFnMesh meshFn(dagPath());
+
+    MMeshSmoothOptions options;
+    meshFn.getSmoothMeshDisplayOptions(options);
+    options.setDivisions(m_smoothLevel);
+
+    MFnMeshData meshDataFn;
+    m_smoothMeshData = meshDataFn.create();
+    m_smoothMesh = meshFn.generateSmoothMesh(m_smoothMeshData, &options, &status);
+
+    if (!status)
+    {
+        RENDERER_LOG_WARNING(
+            "Couldn't subdivide mesh %s, exporting the cage instead.",
+            appleseedName().asChar());
+
+        m_smoothLevel = 0;
+        m_smoothMeshData = MObject::kNullObj;
+        m_smoothMesh = MObject::kNullObj;
+        return;
+    }
+}
+
 void MeshExporter::createMaterialSlots()
 {
     // Create material slots.
@@ -449,91 +984,26 @@ void MeshExporter::createMaterialSlots()
         m_mesh->push_material_slot("default");
 }
 
-void MeshExporter::fillTopology()
+int MeshExporter::faceMaterialIndex(const int faceIndex) const
 {
-    MStatus status;
+    // Meshes with per-face materials are never smoothed.
+    if (m_perFaceAssignments.length() != 0)
+        return m_perFaceAssignments[faceIndex];
+
+    return 0;
+}
 
+void MeshExporter::fillTopology()
+{
     // Triangle buffer.
     std::vector<asr::Triangle> triangles;
+    FaceTriangulator triangulator(m_exportUVs, m_exportNormals);
 
-    MIntArray faceVertexIndices;
-    MIntArray faceUVIndices;
-    MIntArray faceNormalIndices;
-    MIntArray triangleVertexIndices;
-    MPointArray trianglePoints;
-
-    MItMeshPolygon faceIt(dagPath());
+    MItMeshPolygon faceIt(meshObject());
     for(; !faceIt.isDone(); faceIt.next())
     {
-        // Get the material index for this face.
-        int materialIndex = 0;
-        if (m_perFaceAssignments.length() != 0)
-            materialIndex = m_perFaceAssignments[faceIt.index()];
-
-        // Collect normal and uv indices for this face.
-        faceUVIndices.clear();
-        faceNormalIndices.clear();
-
-        faceIt.getVertices(faceVertexIndices);
-        for(size_t i = 0, e = faceVertexIndices.length(); i < e; ++i)
-        {
-            if (m_exportUVs)
-            {
-                int uvIndex;
-                status = faceIt.getUVIndex(i, uvIndex);
-                faceUVIndices.append(uvIndex);
-            }
-
-            if (m_exportNormals)
-            {
-                unsigned int normalIndex = faceIt.normalIndex(i, &status);
-                faceNormalIndices.append(normalIndex);
-            }
-        }
-
-        // Match the triangle indices to the face indices.
-        int numTris;
-        faceIt.numTriangles(numTris);
-        for(size_t i = 0; i < numTris; ++i)
-        {
-            trianglePoints.clear();
-            triangleVertexIndices.clear();
-            faceIt.getTriangle(i, trianglePoints, triangleVertexIndices);
-
-            int triangleVertexOffset[3] = {-1, -1, -1};
-            for(size_t j = 0, je = faceVertexIndices.length(); j < je; ++j)
-            {
-                if (faceVertexIndices[j] == triangleVertexIndices[0])
-                    triangleVertexOffset[0] = j;
-                else if (faceVertexIndices[j] == triangleVertexIndices[1])
-                    triangleVertexOffset[1] = j;
-                else if (faceVertexIndices[j] == triangleVertexIndices[2])
-                    triangleVertexOffset[2] = j;
-            }
-
-
-            asr::Triangle triangle(
-                faceVertexIndices[triangleVertexOffset[0]],
-                faceVertexIndices[triangleVertexOffset[1]],
-                faceVertexIndices[triangleVertexOffset[2]],
-                materialIndex);
-
-            if (m_exportUVs)
-            {
-                triangle.m_a0 = faceUVIndices[triangleVertexOffset[0]];
-                triangle.m_a1 = faceUVIndices[triangleVertexOffset[1]];
-                triangle.m_a2 = faceUVIndices[triangleVertexOffset[2]];
-            }
-
-            if (m_exportNormals)
-            {
-                triangle.m_n0 = faceNormalIndices[triangleVertexOffset[0]];
-                triangle.m_n1 = faceNormalIndices[triangleVertexOffset[1]];
-                triangle.m_n2 = faceNormalIndices[triangleVertexOffset[2]];
-            }
-
-            triangles.push_back(triangle);
-        }
+        Computation::checkpoint();
+        triangulator.triangulate(faceIt, faceMaterialIndex(faceIt.index()), triangles);
     }
 
     // Copy triangles to the mesh.
@@ -545,14 +1015,17 @@ void MeshExporter::fillTopology()
 void MeshExporter::exportGeometry()
 {
     MStatus status;
-    MFnMesh meshFn(dagPath());
+    MFnMesh meshFn(meshObject());
 
     // Vertices.
     m_mesh->reserve_vertices(meshFn.numVertices());
     {
         const float *p = meshFn.getRawPoints(&status);
         for(size_t i = 0, e = meshFn.numVertices(); i < e; ++i, p += 3)
-            m_mesh->push_vertex(asr::GVector3(p[0], p[1], p[2]));
+        {
+            Computation::checkpoint();
+            m_mesh->push_vertex(vertexPosition(p, i));
+        }
     }
 
     if (m_exportUVs)
@@ -561,7 +1034,10 @@ void MeshExporter::exportGeometry()
         MFloatArray u, v;
         status = meshFn.getUVs(u, v);
         for(size_t i = 0, e = meshFn.numUVs(); i < e; ++i)
+        {
+            Computation::checkpoint();
             m_mesh->push_tex_coords(asr::GVector2(u[i], v[i]));
+        }
     }
 
     if (m_exportNormals)
@@ -572,6 +1048,7 @@ void MeshExporter::exportGeometry()
 
         for(size_t i = 0, e = meshFn.numNormals(); i < e; ++i, p += 3)
         {
+            Computation::checkpoint();
             asr::GVector3 n(p[0], p[1], p[2]);
             m_mesh->push_vertex_normal(asf::safe_normalize(n, Y));
         }
@@ -581,11 +1058,31 @@ void MeshExporter::exportGeometry()
 void MeshExporter::exportMeshKey()
 {
     MStatus status;
-    MFnMesh meshFn(dagPath());
+    MFnMesh meshFn(meshObject());
+
+    // Drop keys identical to the first one. Motion segments are evenly
+    // spaced over the shutter, so we only allocate them once a key differs.
+    if (m_isDeforming && m_mesh->get_motion_segment_count() == 0)
+    {
+        if (pointsHash(meshFn) == m_firstKeyHash)
+            return;
+
+        // Reserve number of keys.
+        m_mesh->set_motion_segment_count(m_numMeshKeys - 1);
+
+        // Copy the first key to the keys we skipped.
+        for(size_t j = 0; j + 1 < m_shapeExportStep; ++j)
+        {
+            for(size_t i = 0, e = m_mesh->get_vertex_count(); i < e; ++i)
+                m_mesh->set_vertex_pose(i, j, m_mesh->get_vertex(i));
 
-    if (m_shapeExportStep == 1)
+            for(size_t i = 0, e = m_mesh->get_vertex_normal_count(); i < e; ++i)
+                m_mesh->set_vertex_normal_pose(i, j, m_mesh->get_vertex_normal(i));
+        }
+    }
+    else if (m_shapeExportStep == 1)
     {
-        assert(m_isDeforming);
+        assert(m_velocityBlur);
         assert(m_numMeshKeys > 1);
 
         // Reserve number of keys.
@@ -597,10 +1094,11 @@ void MeshExporter::exportMeshKey()
         const float *p = meshFn.getRawPoints(&status);
         for(size_t i = 0, e = meshFn.numVertices(); i < e; ++i, p += 3)
         {
+            Computation::checkpoint();
             m_mesh->set_vertex_pose(
                 i,
                 m_shapeExportStep - 1,
-                asr::GVector3(p[0], p[1], p[2]));
+                vertexPosition(p, i));
         }
     }
 
@@ -612,6 +1110,7 @@ void MeshExporter::exportMeshKey()
 
         for(size_t i = 0, e = meshFn.numNormals(); i < e; ++i, p += 3)
         {
+            Computation::checkpoint();
             asr::GVector3 n(p[0], p[1], p[2]);
             m_mesh->set_vertex_normal_pose(
                 i,
@@ -620,3 +1119,18 @@ void MeshExporter::exportMeshKey()
         }
     }
 }
+
+MurmurHash MeshExporter::pointsHash(const MFnMesh& meshFn) const
+{
+    MStatus status;
+    MurmurHash hash;
+
+    const float *p = meshFn.getRawPoints(&status);
+    for(size_t i = 0, e = meshFn.numVertices(); i < e; ++i, p += 3)
+    {
+        Computation::checkpoint();
+        hash.append(asr::GVector3(p[0], p[1], p[2]));
+    }
+
+    return hash;
+}
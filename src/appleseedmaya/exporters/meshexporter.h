@@ -35,6 +35,7 @@
 
 // Maya headers.
 #include <maya/MIntArray.h>
+#include <maya/MObject.h>
 
 // appleseed.foundation headers.
 #include "renderer/api/material.h"
@@ -49,6 +50,9 @@
 #include "appleseedmaya/exporters/alphamapexporterfwd.h"
 #include "appleseedmaya/exporters/shapeexporter.h"
 
+// Forward declarations.
+class MFnMesh;
+
 class MeshExporter
   : public ShapeExporter
 {
@@ -63,18 +67,37 @@ class MeshExporter
 
     ~MeshExporter();
 
+    virtual bool supportsInstancing() const;
+
+    // Per-face assignments are part of the geometry,
+    // instances with different ones can not share it.
+    virtual bool canInstance(const MDagPath& path) const;
+
+    virtual MString objectName() const;
+
+    virtual void createMaterialMappings(
+        const MDagPath&                             path,
+        const AppleseedSession::Services&           services,
+        foundation::StringDictionary&               frontMaterialMappings,
+        foundation::StringDictionary&               backMaterialMappings,
+        MIntArray&                                  perFaceAssignments) const;
+
     virtual void createExporters(const AppleseedSession::Services& services);
 
     virtual void createEntities(
         const AppleseedSession::Options&            options,
         const AppleseedSession::MotionBlurTimes&    motionBlurTimes);
 
+    virtual bool needsShapeMotionSteps() const;
+
     virtual void exportShapeMotionStep(float time);
 
     virtual void flushEntities();
 
   private:
 
+    class MeshFileWalker;
+
     MeshExporter(
       const MDagPath&                               path,
       renderer::Project&                            project,
@@ -82,6 +105,21 @@ class MeshExporter
 
     void meshAttributesToParams(renderer::ParamArray& params);
 
+    // Return the mesh to export, either the shape itself or its smoothed version.
+    MObject meshObject() const;
+    void updateSmoothMesh();
+
+    void exportMeshFile();
+
+    // Velocity blur.
+    void readVelocities();
+    renderer::GVector3 vertexPosition(const float* p, const size_t index) const;
+
+    MurmurHash pointsHash(const MFnMesh& meshFn) const;
+
+    // Return the index of the material slot of a face of the exported mesh.
+    int faceMaterialIndex(const int faceIndex) const;
+
     void createMaterialSlots();
     void fillTopology();
     void exportGeometry();
@@ -95,8 +133,16 @@ class MeshExporter
     bool                                        m_exportReference;
     std::vector<std::string>                    m_fileNames;
     MIntArray                                   m_perFaceAssignments;
+    int                                         m_smoothLevel;
+    MObject                                     m_smoothMeshData;
+    MObject                                     m_smoothMesh;
     bool                                        m_isDeforming;
+    bool                                        m_velocityBlur;
+    std::vector<renderer::GVector3>             m_velocities;
+    std::vector<float>                          m_deformTimes;
+    float                                       m_keyTimeOffset;
     size_t                                      m_numMeshKeys;
+    MurmurHash                                  m_firstKeyHash;
     size_t                                      m_shapeExportStep;
     AlphaMapExporterPtr                         m_alphaMapExporter;
 };
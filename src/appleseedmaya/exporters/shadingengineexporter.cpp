@@ -44,6 +44,14 @@
 namespace asf = foundation;
 namespace asr = renderer;
 
+namespace
+{
+
+const AttributeUtils::CachedAttribute g_surfaceShader("surfaceShader");
+const AttributeUtils::CachedAttribute g_asShadingSamples("asShadingSamples");
+
+}
+
 ShadingEngineExporter::ShadingEngineExporter(
     const MObject&                  object,
     asr::Assembly&                  mainAssembly,
@@ -54,6 +62,37 @@ ShadingEngineExporter::ShadingEngineExporter(
 {
 }
 
+MString ShadingEngineExporter::materialName() const
+{
+    MFnDependencyNode depNodeFn(m_object);
+
+    if (m_sessionMode == AppleseedSession::ProgressiveRenderSession)
+        return depNodeFn.name() + MString("_material");
+
+    // Shading engines with the same surface network and
+    // shading samples share the same material.
+    MString name("default");
+
+    MStatus status;
+    const MPlug plug = g_surfaceShader.findPlug(depNodeFn, &status);
+    if (plug.isConnected())
+    {
+        MPlugArray otherPlugs;
+        plug.connectedTo(otherPlugs, true, false, &status);
+        if (otherPlugs.length() == 1)
+            name = MFnDependencyNode(otherPlugs[0].node()).name();
+    }
+
+    const int numSamples = shadingSamples();
+    if (numSamples > 1)
+    {
+        name += "_samples_";
+        name += numSamples;
+    }
+
+    return name + MString("_material");
+}
+
 ShadingEngineExporter::~ShadingEngineExporter()
 {
     if (m_sessionMode == AppleseedSession::ProgressiveRenderSession)
@@ -70,7 +109,7 @@ void ShadingEngineExporter::createExporters(const AppleseedSession::Services& se
     MFnDependencyNode depNodeFn(m_object);
 
     MStatus status;
-    const MPlug plug = depNodeFn.findPlug("surfaceShader", &status);
+    const MPlug plug = g_surfaceShader.findPlug(depNodeFn, &status);
     if (plug.isConnected())
     {
         MPlugArray otherPlugs;
@@ -97,12 +136,17 @@ void ShadingEngineExporter::createEntities(const AppleseedSession::Options& opti
     const MString appleseedName = depNodeFn.name();
 
     // Create a surface shader if needed.
-    int numSamples = 1;
-    AttributeUtils::get(depNodeFn, "asShadingSamples", numSamples);
-
+    const int numSamples = shadingSamples();
     if (numSamples > 1)
     {
+        // Surface shaders only depend on the number of samples and are shared.
         MString surfaceShaderName = appleseedName + MString("_surface_shader");
+        if (m_sessionMode != AppleseedSession::ProgressiveRenderSession)
+        {
+            surfaceShaderName = "physical_surface_shader_samples_";
+            surfaceShaderName += numSamples;
+        }
+
         m_surfaceShader.reset(
             asr::PhysicalSurfaceShaderFactory().create(
                 surfaceShaderName.asChar(),
@@ -110,9 +154,8 @@ void ShadingEngineExporter::createEntities(const AppleseedSession::Options& opti
     }
 
     // Create the material.
-    MString materialName = appleseedName + MString("_material");
     m_material.reset(asr::OSLMaterialFactory().create(
-        materialName.asChar(), asr::ParamArray()));
+        materialName().asChar(), asr::ParamArray()));
 
     // Set the surface shader in the material.
     if (m_surfaceShader.get())
@@ -122,7 +165,7 @@ void ShadingEngineExporter::createEntities(const AppleseedSession::Options& opti
 void ShadingEngineExporter::flushEntities()
 {
     if (m_surfaceShader.get())
-        m_mainAssembly.surface_shaders().insert(m_surfaceShader.release());
+        insertSharedEntity(m_mainAssembly.surface_shaders(), m_surfaceShader);
 
     if (m_surfaceNetworkExporter)
     {
@@ -131,6 +174,13 @@ void ShadingEngineExporter::flushEntities()
             m_surfaceNetworkExporter->shaderGroupName().asChar());
     }
 
-    m_mainAssembly.materials().insert(m_material.release());
+    insertSharedEntity(m_mainAssembly.materials(), m_material);
+}
+
+int ShadingEngineExporter::shadingSamples() const
+{
+    int numSamples = 1;
+    AttributeUtils::get(m_object, g_asShadingSamples, numSamples);
+    return numSamples;
 }
 
@@ -54,6 +54,9 @@ class ShadingEngineExporter
 
     ~ShadingEngineExporter();
 
+    // Return the name of the appleseed material used by this shading engine.
+    MString materialName() const;
+
     // Create any extra exporter needed by this exporter (shading networks, ...).
     void createExporters(const AppleseedSession::Services& services);
 
@@ -71,6 +74,8 @@ class ShadingEngineExporter
         renderer::Assembly&           mainAssembly,
         AppleseedSession::SessionMode sessionMode);
 
+    int shadingSamples() const;
+
     AppleseedSession::SessionMode                   m_sessionMode;
     MObject                                         m_object;
     renderer::Assembly&                             m_mainAssembly;
@@ -31,6 +31,8 @@
 
 // Standard headers.
 #include <algorithm>
+#include <map>
+#include <string>
 
 // Maya headers.
 #include <maya/MItDependencyGraph.h>
@@ -44,6 +46,7 @@
 #include "appleseedmaya/exporters/exporterfactory.h"
 #include "appleseedmaya/exporters/shadingnodeexporter.h"
 #include "appleseedmaya/logger.h"
+#include "appleseedmaya/murmurhash.h"
 #include "appleseedmaya/shadingnodemetadata.h"
 #include "appleseedmaya/shadingnoderegistry.h"
 
@@ -74,6 +77,36 @@ MStatus logUnknownAttributeFound(
     return status;
 }
 
+// Hash the contents of a shader group, ignoring the names of its layers.
+MurmurHash hashShaderGroup(const asr::ShaderGroup& shaderGroup)
+{
+    MurmurHash hash;
+
+    std::map<std::string, size_t> layerIndices;
+    const asr::ShaderContainer& shaders = shaderGroup.shaders();
+    for (size_t i = 0, e = shaders.size(); i < e; ++i)
+    {
+        const asr::Shader* shader = shaders.get_by_index(i);
+        layerIndices[shader->get_layer()] = i;
+
+        hash.append(shader->get_type());
+        hash.append(shader->get_shader());
+        hash.append(static_cast<const asf::Dictionary&>(shader->get_parameters()));
+    }
+
+    const asr::ShaderConnectionContainer& connections = shaderGroup.shader_connections();
+    for (size_t i = 0, e = connections.size(); i < e; ++i)
+    {
+        const asr::ShaderConnection* connection = connections.get_by_index(i);
+        hash.append(layerIndices[connection->get_src_layer()]);
+        hash.append(connection->get_src_param());
+        hash.append(layerIndices[connection->get_dst_layer()]);
+        hash.append(connection->get_dst_param());
+    }
+
+    return hash;
+}
+
 }
 
 ShadingNetworkExporter::ShadingNetworkExporter(
@@ -81,11 +114,13 @@ ShadingNetworkExporter::ShadingNetworkExporter(
     const MObject&                object,
     const MPlug&                  outputPlug,
     renderer::Assembly&           mainAssembly,
+    UniqueNameAllocator&          nameAllocator,
     AppleseedSession::SessionMode sessionMode)
   : m_context(context)
   , m_object(object)
   , m_outputPlug(outputPlug)
   , m_mainAssembly(mainAssembly)
+  , m_nameAllocator(nameAllocator)
   , m_sessionMode(sessionMode)
 {
 }
@@ -98,8 +133,8 @@ ShadingNetworkExporter::~ShadingNetworkExporter()
 
 MString ShadingNetworkExporter::shaderGroupName() const
 {
-    assert(m_shaderGroup.get());
-    return m_shaderGroup->get_name();
+    assert(m_shaderGroupName.length() != 0);
+    return m_shaderGroupName;
 }
 
 void ShadingNetworkExporter::createEntities()
@@ -187,9 +222,30 @@ void ShadingNetworkExporter::flushEntities()
         break;
     }
 
+    // Area lights with identical shading networks share a shader group.
+    if (m_context == AreaLightNetworkContext &&
+        m_sessionMode != AppleseedSession::ProgressiveRenderSession)
+    {
+        const std::string sharedName =
+            "area_light_" + hashShaderGroup(*m_shaderGroup).toString() + "_shader_group";
+        m_shaderGroupName = sharedName.c_str();
+
+        if (m_mainAssembly.shader_groups().get_by_name(sharedName.c_str()) == 0)
+        {
+            m_shaderGroup->set_name(sharedName.c_str());
+            m_mainAssembly.shader_groups().insert(m_shaderGroup.release());
+        }
+        else
+            m_shaderGroup.reset();
+
+        return;
+    }
+
     insertEntityWithUniqueName(
         m_mainAssembly.shader_groups(),
-        m_shaderGroup);
+        m_shaderGroup,
+        m_nameAllocator);
+    m_shaderGroupName = m_shaderGroup->get_name();
 }
 
 void ShadingNetworkExporter::createShaderNodeExporters(const MObject& node)
@@ -76,6 +76,7 @@ class ShadingNetworkExporter
       const MObject&                object,
       const MPlug&                  outputPlug,
       renderer::Assembly&           mainAssembly,
+      UniqueNameAllocator&          nameAllocator,
       AppleseedSession::SessionMode sessionMode);
 
     void createShaderNodeExporters(const MObject& node);
@@ -85,7 +86,9 @@ class ShadingNetworkExporter
     MObject                                     m_object;
     MPlug                                       m_outputPlug;
     renderer::Assembly&                         m_mainAssembly;
+    UniqueNameAllocator&                        m_nameAllocator;
     AppleseedEntityPtr<renderer::ShaderGroup>   m_shaderGroup;
+    MString                                     m_shaderGroupName;
     std::vector<ShadingNodeExporterPtr>         m_nodeExporters;
     ShadingNodeExporterMap                      m_namesToExporters;
 };
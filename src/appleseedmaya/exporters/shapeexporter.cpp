@@ -29,12 +29,34 @@
 // Interface header.
 #include "appleseedmaya/exporters/shapeexporter.h"
 
+// Maya headers.
+#include <maya/MFnDependencyNode.h>
+#include <maya/MPlug.h>
+#include <maya/MPlugArray.h>
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+
 // appleseed.renderer headers.
 #include "renderer/api/scene.h"
 
+// appleseed.maya headers.
+#include "appleseedmaya/attributeutils.h"
+#include "appleseedmaya/exporters/shadingengineexporter.h"
+
 namespace asf = foundation;
 namespace asr = renderer;
 
+namespace
+{
+
+const AttributeUtils::CachedAttribute g_instObjGroups("instObjGroups");
+const AttributeUtils::CachedAttribute g_asTransformSamples("asTransformSamples");
+const AttributeUtils::CachedAttribute g_asDeformSamples("asDeformSamples");
+const AttributeUtils::CachedAttribute g_asDoubleSided("asDoubleSided");
+
+}
+
 ShapeExporter::ShapeExporter(
     const MDagPath&                 path,
     asr::Project&                   project,
@@ -48,10 +70,11 @@ ShapeExporter::~ShapeExporter()
 {
     if (sessionMode() == AppleseedSession::ProgressiveRenderSession)
     {
-        assert(m_objectAssembly.get());
+        if (m_objectAssembly.get())
+            mainAssembly().assemblies().remove(m_objectAssembly.get());
 
-        mainAssembly().assemblies().remove(m_objectAssembly.get());
-        mainAssembly().assembly_instances().remove(m_objectAssemblyInstance.get());
+        if (m_objectAssemblyInstance.get())
+            mainAssembly().assembly_instances().remove(m_objectAssemblyInstance.get());
     }
 }
 
@@ -60,16 +83,99 @@ const asr::TransformSequence& ShapeExporter::transformSequence() const
     return m_transformSequence;
 }
 
+bool ShapeExporter::supportsInstancing() const
+{
+    return false;
+}
+
+bool ShapeExporter::canInstance(const MDagPath& path) const
+{
+    return supportsInstancing();
+}
+
 void ShapeExporter::instanceCreated() const
 {
     m_numInstances++;
 }
 
-void ShapeExporter::exportTransformMotionStep(float time)
+MString ShapeExporter::objectName() const
+{
+    return appleseedName();
+}
+
+void ShapeExporter::createMaterialMappings(
+    const MDagPath&                     path,
+    const AppleseedSession::Services&   services,
+    asf::StringDictionary&              frontMaterialMappings,
+    asf::StringDictionary&              backMaterialMappings,
+    MIntArray&                          perFaceAssignments) const
 {
-    asf::Matrix4d m = convert(dagPath().inclusiveMatrix());
-    asf::Matrix4d invM = convert(dagPath().inclusiveMatrixInverse());
-    asf::Transformd xform(m, invM);
+    const int instanceNumber = path.isInstanced() ? path.instanceNumber() : 0;
+
+    MFnDependencyNode depNodeFn(path.node());
+    MPlug plug = g_instObjGroups.findPlug(depNodeFn);
+    plug = plug.elementByLogicalIndex(instanceNumber);
+
+    if (plug.isConnected())
+    {
+        // We have only one material for the shape.
+        MPlugArray connections;
+        plug.connectedTo(connections, false, true);
+        addMaterialMapping(
+            services,
+            connections[0].node(),
+            "default",
+            frontMaterialMappings,
+            backMaterialMappings);
+    }
+}
+
+const asf::StringDictionary& ShapeExporter::frontMaterialMappings() const
+{
+    return m_frontMaterialMappings;
+}
+
+const asf::StringDictionary& ShapeExporter::backMaterialMappings() const
+{
+    return m_backMaterialMappings;
+}
+
+void ShapeExporter::collectMotionBlurSteps(AppleseedSession::MotionBlurTimes& motionTimes) const
+{
+    // Motion blur is disabled.
+    if (motionTimes.m_shutterOpenTime == motionTimes.m_shutterCloseTime)
+        return;
+
+    // A value of 0 means use the render globals settings.
+    int transformSamples = 0;
+    AttributeUtils::get(node(), g_asTransformSamples, transformSamples);
+    if (transformSamples > 0)
+    {
+        motionTimes.initializeFrameSet(
+            transformSamples,
+            motionTimes.m_shutterOpenTime,
+            motionTimes.m_shutterCloseTime,
+            motionTimes.m_transformTimes);
+    }
+
+    int deformSamples = 0;
+    AttributeUtils::get(node(), g_asDeformSamples, deformSamples);
+    if (deformSamples > 0)
+    {
+        if (!asf::is_pow2(deformSamples))
+            deformSamples = asf::next_pow2(deformSamples);
+
+        motionTimes.initializeFrameSet(
+            deformSamples,
+            motionTimes.m_shutterOpenTime,
+            motionTimes.m_shutterCloseTime,
+            motionTimes.m_deformTimes);
+    }
+}
+
+void ShapeExporter::exportTransformMotionStep(float time, TransformCache& transformCache)
+{
+    const asf::Transformd xform = assemblyTransform(transformCache);
     m_transformSequence.set_transform(time, xform);
 }
 
@@ -105,6 +211,25 @@ void ShapeExporter::shapeAttributesToParams(renderer::ParamArray& params)
 {
 }
 
+void ShapeExporter::addMaterialMapping(
+    const AppleseedSession::Services&   services,
+    const MObject&                      shadingEngine,
+    const char*                         slotName,
+    asf::StringDictionary&              frontMaterialMappings,
+    asf::StringDictionary&              backMaterialMappings)
+{
+    ShadingEngineExporterPtr exporter = services.createShadingEngineExporter(shadingEngine);
+    const MString materialName = exporter->materialName();
+
+    MFnDependencyNode depNodeFn(shadingEngine);
+    frontMaterialMappings.insert(slotName, materialName.asChar());
+
+    bool doubleSided = false;
+    AttributeUtils::get(depNodeFn, g_asDoubleSided, doubleSided);
+    if (doubleSided)
+        backMaterialMappings.insert(slotName, materialName.asChar());
+}
+
 void ShapeExporter::createObjectInstance(const MString& objectName)
 {
     asr::Assembly *objectAssembly = &mainAssembly();
@@ -32,6 +32,9 @@
 // Standard headers.
 #include <vector>
 
+// Maya headers.
+#include <maya/MIntArray.h>
+
 // appleseed.renderer headers.
 #include "renderer/api/scene.h"
 #include "renderer/api/utility.h"
@@ -49,9 +52,32 @@ class ShapeExporter
 
     const renderer::TransformSequence& transformSequence() const;
 
+    // Return true if other dag paths to the same shape can reuse this exporter's geometry.
+    virtual bool supportsInstancing() const;
+
+    // Return true if another dag path to the same shape can reuse this exporter's geometry.
+    virtual bool canInstance(const MDagPath& path) const;
+
     void instanceCreated() const;
 
-    virtual void exportTransformMotionStep(float time);
+    // Return the name of the appleseed object referenced by object instances.
+    virtual MString objectName() const;
+
+    // Collect the material mappings of this shape as seen from a given dag path.
+    virtual void createMaterialMappings(
+        const MDagPath&                             path,
+        const AppleseedSession::Services&           services,
+        foundation::StringDictionary&               frontMaterialMappings,
+        foundation::StringDictionary&               backMaterialMappings,
+        MIntArray&                                  perFaceAssignments) const;
+
+    const foundation::StringDictionary& frontMaterialMappings() const;
+    const foundation::StringDictionary& backMaterialMappings() const;
+
+    // Apply per object motion blur samples overrides.
+    virtual void collectMotionBlurSteps(AppleseedSession::MotionBlurTimes& motionTimes) const;
+
+    virtual void exportTransformMotionStep(float time, TransformCache& transformCache);
 
     virtual void flushEntities() = 0;
 
@@ -64,6 +90,14 @@ class ShapeExporter
 
     void shapeAttributesToParams(renderer::ParamArray& params);
 
+    // Map a material slot to the material created for a shading engine.
+    static void addMaterialMapping(
+        const AppleseedSession::Services&           services,
+        const MObject&                              shadingEngine,
+        const char*                                 slotName,
+        foundation::StringDictionary&               frontMaterialMappings,
+        foundation::StringDictionary&               backMaterialMappings);
+
     void createObjectInstance(const MString& objectName);
 
     renderer::TransformSequence                     m_transformSequence;
@@ -46,7 +46,7 @@ namespace asr = renderer;
 
 void XGenExporter::registerExporter()
 {
-    NodeExporterFactory::registerDagNodeExporter("xgmDescription", &XGenExporter::create);
+    NodeExporterFactory::registerDagNodeExporter("xgmDescription", &XGenExporter::create, true);
 }
 
 DagNodeExporter *XGenExporter::create(
@@ -153,11 +153,9 @@ void XGenExporter::createEntities(
         asr::AssemblyFactory().create(assemblyName.asChar(), params));
 }
 
-void XGenExporter::exportTransformMotionStep(float time)
+void XGenExporter::exportTransformMotionStep(float time, TransformCache& transformCache)
 {
-    asf::Matrix4d m = convert(dagPath().inclusiveMatrix());
-    asf::Matrix4d invM = convert(dagPath().inclusiveMatrixInverse());
-    asf::Transformd xform(m, invM);
+    const asf::Transformd xform = assemblyTransform(transformCache);
     m_transformSequence.set_transform(time, xform);
 }
 
@@ -62,7 +62,7 @@ class XGenExporter
         const AppleseedSession::Options&            options,
         const AppleseedSession::MotionBlurTimes&    motionBlurTimes);
 
-    virtual void exportTransformMotionStep(float time);
+    virtual void exportTransformMotionStep(float time, TransformCache& transformCache);
 
     virtual void flushEntities();
 
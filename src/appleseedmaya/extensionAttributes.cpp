@@ -189,6 +189,96 @@ void addMeshExtensionAttributes()
     AttributeUtils::makeInput(numAttrFn);
     modifier.addExtensionAttribute(nodeClass, attr);
 
+    attr = createNumericAttribute<int>(
+        numAttrFn,
+        "asTransformSamples",
+        "asTransformSamples",
+        MFnNumericData::kInt,
+        0,
+        status);
+    numAttrFn.setMin(0);
+    AttributeUtils::makeInput(numAttrFn);
+    modifier.addExtensionAttribute(nodeClass, attr);
+
+    attr = createNumericAttribute<int>(
+        numAttrFn,
+        "asDeformSamples",
+        "asDeformSamples",
+        MFnNumericData::kInt,
+        0,
+        status);
+    numAttrFn.setMin(0);
+    AttributeUtils::makeInput(numAttrFn);
+    modifier.addExtensionAttribute(nodeClass, attr);
+
+    attr = createNumericAttribute<bool>(
+        numAttrFn,
+        "asVelocityBlur",
+        "asVelocityBlur",
+        MFnNumericData::kBoolean,
+        false,
+        status);
+    AttributeUtils::makeInput(numAttrFn);
+    modifier.addExtensionAttribute(nodeClass, attr);
+
+    MFnStringData stringDataFn;
+    MObject defaultColorSet = stringDataFn.create("velocityPV");
+
+    MFnTypedAttribute typedAttrFn;
+    attr = typedAttrFn.create(
+        "asVelocityColorSet",
+        "asVelocityColorSet",
+        MFnData::kString,
+        defaultColorSet,
+        &status);
+    typedAttrFn.addToCategory(g_extensionsCategory);
+    AttributeUtils::makeInput(typedAttrFn);
+    modifier.addExtensionAttribute(nodeClass, attr);
+
+    attr = createNumericAttribute<float>(
+        numAttrFn,
+        "asVelocityScale",
+        "asVelocityScale",
+        MFnNumericData::kFloat,
+        1.0f,
+        status);
+    AttributeUtils::makeInput(numAttrFn);
+    modifier.addExtensionAttribute(nodeClass, attr);
+
+    addVisibilityExtensionAttributes(nodeClass, modifier);
+    modifier.doIt();
+}
+
+void addNurbsCurveExtensionAttributes()
+{
+    MNodeClass nodeClass("nurbsCurve");
+    MDGModifier modifier;
+
+    MStatus status;
+
+    MFnNumericAttribute numAttrFn;
+
+    MObject attr = createNumericAttribute<bool>(
+        numAttrFn,
+        "asRenderCurve",
+        "asRenderCurve",
+        MFnNumericData::kBoolean,
+        false,
+        status);
+    AttributeUtils::makeInput(numAttrFn);
+    modifier.addExtensionAttribute(nodeClass, attr);
+
+    attr = createNumericAttribute<float>(
+        numAttrFn,
+        "asCurveWidth",
+        "asCurveWidth",
+        MFnNumericData::kFloat,
+        0.01f,
+        status);
+    numAttrFn.setMin(0.0f);
+    AttributeUtils::makeInput(numAttrFn);
+    modifier.addExtensionAttribute(nodeClass, attr);
+
     addVisibilityExtensionAttributes(nodeClass, modifier);
     modifier.doIt();
 }
@@ -321,13 +411,37 @@ void addShadingEngineExtensionAttrs()
     modifier.doIt();
 }
 
+void addTransformExtensionAttributes()
+{
+    MNodeClass nodeClass("transform");
+    MDGModifier modifier;
+
+    MStatus status;
+
+    MFnNumericAttribute numAttrFn;
+
+    MObject attr = createNumericAttribute<bool>(
+        numAttrFn,
+        "asExportAsAssembly",
+        "asExportAsAssembly",
+        MFnNumericData::kBoolean,
+        false,
+        status);
+    AttributeUtils::makeInput(numAttrFn);
+    modifier.addExtensionAttribute(nodeClass, attr);
+
+    modifier.doIt();
+}
+
 } // unnamed.
 
 MStatus addExtensionAttributes()
 {
     addMeshExtensionAttributes();
+    addNurbsCurveExtensionAttributes();
     addAreaLightExtensionAttributes();
     addBump2dExtensionAttributes();
     addShadingEngineExtensionAttrs();
+    addTransformExtensionAttributes();
     return MS::kSuccess;
 }
@@ -44,6 +44,8 @@
 #include "appleseedmaya/renderglobalsnode.h"
 #include "appleseedmaya/shadingnoderegistry.h"
 #include "appleseedmaya/swatchrenderer.h"
+#include "appleseedmaya/textureconverter.h"
+#include "appleseedmaya/threadbudget.h"
 #include "appleseedmaya/hypershaderenderer.h"
 
 #ifdef APPLESEED_MAYA_WITH_PYTHON_BRIDGE
@@ -254,6 +256,8 @@ APPLESEED_MAYA_PLUGIN_EXPORT MStatus initializePlugin(MObject plugin)
 #endif
 
     IdleJobQueue::initialize();
+    TextureConverter::initialize();
+    ThreadBudget::initialize();
 
     RENDERER_LOG_INFO("Registration done!");
     return status;
@@ -281,6 +285,8 @@ APPLESEED_MAYA_PLUGIN_EXPORT MStatus uninitializePlugin(MObject plugin)
     // Internal.
 
     IdleJobQueue::uninitialize();
+    TextureConverter::uninitialize();
+    ThreadBudget::uninitialize();
 
     status = AppleseedSession::uninitialize();
     APPLESEED_MAYA_CHECK_MSTATUS_MSG_LOG(
@@ -0,0 +1,397 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "appleseedmaya/rendercheckpoint.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
+// Boost headers.
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
+#include "boost/scoped_ptr.hpp"
+#include "boost/thread/locks.hpp"
+
+// OpenImageIO headers.
+#include "OpenImageIO/imageio.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/aabb.h"
+#include "foundation/platform/types.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/frame.h"
+#include "renderer/api/rendering.h"
+
+// appleseed.maya headers.
+#include "appleseedmaya/logger.h"
+
+namespace bfs = boost::filesystem;
+namespace asf = foundation;
+namespace asr = renderer;
+
+namespace
+{
+
+const char* TileSizeAttribute = "appleseedMaya:checkpointTileSize";
+const char* DoneTilesAttribute = "appleseedMaya:checkpointTiles";
+
+class CheckpointTileCallback
+  : public asr::ITileCallback
+{
+  public:
+    explicit CheckpointTileCallback(RenderCheckpoint& checkpoint)
+      : m_checkpoint(checkpoint)
+    {
+    }
+
+    virtual void release()
+    {
+        delete this;
+    }
+
+    virtual void pre_render(
+        const size_t        x,
+        const size_t        y,
+        const size_t        width,
+        const size_t        height)
+    {
+    }
+
+    virtual void post_render_tile(
+        const asr::Frame*   frame,
+        const size_t        tile_x,
+        const size_t        tile_y)
+    {
+        m_checkpoint.tileRendered(*frame, tile_x, tile_y);
+    }
+
+    virtual void post_render(
+        const asr::Frame*   frame)
+    {
+    }
+
+  private:
+    RenderCheckpoint& m_checkpoint;
+};
+
+class CheckpointTileCallbackFactory
+  : public asr::ITileCallbackFactory
+{
+  public:
+    explicit CheckpointTileCallbackFactory(RenderCheckpoint& checkpoint)
+      : m_checkpoint(checkpoint)
+    {
+    }
+
+    virtual void release()
+    {
+        delete this;
+    }
+
+    virtual asr::ITileCallback* create()
+    {
+        return new CheckpointTileCallback(m_checkpoint);
+    }
+
+  private:
+    RenderCheckpoint& m_checkpoint;
+};
+
+MString tileSizeString(const size_t tileWidth, const size_t tileHeight)
+{
+    MString s;
+    s += static_cast<int>(tileWidth);
+    s += "x";
+    s += static_cast<int>(tileHeight);
+    return s;
+}
+
+} // unnamed.
+
+RenderCheckpoint::RenderCheckpoint(const MString& outputFileName, const double interval)
+  : m_fileName(outputFileName.asChar())
+  , m_interval(interval)
+  , m_width(0)
+  , m_height(0)
+  , m_tileWidth(0)
+  , m_tileHeight(0)
+  , m_tileCountX(0)
+  , m_tileCountY(0)
+  , m_complete(false)
+  , m_writing(false)
+{
+    m_fileName += ".checkpoint.exr";
+}
+
+bool RenderCheckpoint::resume(asr::Frame& frame)
+{
+    initialize(frame);
+
+    if (!bfs::exists(bfs::path(m_fileName)))
+        return false;
+
+    if (!read())
+    {
+        RENDERER_LOG_WARNING("Ignoring incompatible render checkpoint %s", m_fileName.c_str());
+        std::fill(m_doneTiles.begin(), m_doneTiles.end(), 0);
+        std::fill(m_pixels.begin(), m_pixels.end(), 0.0f);
+        return false;
+    }
+
+    // Find the first row of tiles inside the crop window with missing tiles.
+    const asf::AABB2u cropWindow = frame.get_crop_window();
+    const size_t minTileX = cropWindow.min.x / m_tileWidth;
+    const size_t maxTileX = cropWindow.max.x / m_tileWidth;
+    const size_t minTileY = cropWindow.min.y / m_tileHeight;
+    const size_t maxTileY = cropWindow.max.y / m_tileHeight;
+
+    size_t firstRow = maxTileY + 1;
+    for (size_t ty = minTileY; ty <= maxTileY && firstRow > maxTileY; ++ty)
+    {
+        for (size_t tx = minTileX; tx <= maxTileX; ++tx)
+        {
+            if (!m_doneTiles[ty * m_tileCountX + tx])
+            {
+                firstRow = ty;
+                break;
+            }
+        }
+    }
+
+    m_restoredTiles = m_doneTiles;
+    m_complete = firstRow > maxTileY;
+
+    if (!m_complete && firstRow != minTileY)
+    {
+        frame.set_crop_window(
+            asf::AABB2u(
+                asf::Vector2u(cropWindow.min.x, static_cast<asf::uint32>(firstRow * m_tileHeight)),
+                cropWindow.max));
+    }
+
+    RENDERER_LOG_INFO(
+        "Resuming render from checkpoint %s, starting at tile row %u",
+        m_fileName.c_str(),
+        static_cast<unsigned int>(firstRow));
+    return true;
+}
+
+bool RenderCheckpoint::isComplete() const
+{
+    return m_complete;
+}
+
+asr::ITileCallbackFactory* RenderCheckpoint::createTileCallbackFactory()
+{
+    m_stopwatch.start();
+    return new CheckpointTileCallbackFactory(*this);
+}
+
+void RenderCheckpoint::tileRendered(const asr::Frame& frame, const size_t tileX, const size_t tileY)
+{
+    {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        storeTile(frame, tileX, tileY);
+        m_doneTiles[tileY * m_tileCountX + tileX] = 1;
+
+        // Only one checkpoint is written at a time.
+        if (m_writing)
+            return;
+
+        m_stopwatch.measure();
+        if (m_stopwatch.get_seconds() < m_interval)
+            return;
+
+        // Copy the state to write, so that other tiles can be stored meanwhile.
+        m_writing = true;
+        m_writePixels = m_pixels;
+        m_writeDoneTiles = m_doneTiles;
+    }
+
+    write(m_writePixels, m_writeDoneTiles);
+
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_writing = false;
+    m_stopwatch.start();
+}
+
+void RenderCheckpoint::restoreTiles(asr::Frame& frame) const
+{
+    for (size_t ty = 0; ty < m_tileCountY; ++ty)
+    {
+        for (size_t tx = 0; tx < m_tileCountX; ++tx)
+        {
+            if (m_restoredTiles[ty * m_tileCountX + tx])
+                loadTile(frame, tx, ty);
+        }
+    }
+}
+
+void RenderCheckpoint::remove()
+{
+    boost::system::error_code error;
+    bfs::remove(bfs::path(m_fileName), error);
+}
+
+void RenderCheckpoint::initialize(const asr::Frame& frame)
+{
+    const asf::CanvasProperties& props = frame.image().properties();
+    assert(props.m_channel_count == 4);
+
+    m_width = props.m_canvas_width;
+    m_height = props.m_canvas_height;
+    m_tileWidth = props.m_tile_width;
+    m_tileHeight = props.m_tile_height;
+    m_tileCountX = props.m_tile_count_x;
+    m_tileCountY = props.m_tile_count_y;
+
+    m_pixels.assign(m_width * m_height * 4, 0.0f);
+    m_doneTiles.assign(m_tileCountX * m_tileCountY, 0);
+    m_restoredTiles.assign(m_tileCountX * m_tileCountY, 0);
+    m_complete = false;
+}
+
+void RenderCheckpoint::storeTile(const asr::Frame& frame, const size_t tileX, const size_t tileY)
+{
+    const asf::Tile& tile = frame.image().tile(tileX, tileY);
+    const size_t x0 = tileX * m_tileWidth;
+    const size_t y0 = tileY * m_tileHeight;
+
+    for (size_t y = 0, ye = tile.get_height(); y < ye; ++y)
+    {
+        float* dst = &m_pixels[((y0 + y) * m_width + x0) * 4];
+
+        for (size_t x = 0, xe = tile.get_width(); x < xe; ++x)
+        {
+            for (size_t c = 0; c < 4; ++c)
+                *dst++ = tile.get_component<float>(x, y, c);
+        }
+    }
+}
+
+void RenderCheckpoint::loadTile(asr::Frame& frame, const size_t tileX, const size_t tileY) const
+{
+    asf::Tile& tile = frame.image().tile(tileX, tileY);
+    const size_t x0 = tileX * m_tileWidth;
+    const size_t y0 = tileY * m_tileHeight;
+
+    for (size_t y = 0, ye = tile.get_height(); y < ye; ++y)
+    {
+        const float* src = &m_pixels[((y0 + y) * m_width + x0) * 4];
+
+        for (size_t x = 0, xe = tile.get_width(); x < xe; ++x)
+        {
+            for (size_t c = 0; c < 4; ++c)
+                tile.set_component(x, y, c, *src++);
+        }
+    }
+}
+
+bool RenderCheckpoint::read()
+{
+    boost::scoped_ptr<OIIO::ImageInput> in(OIIO::ImageInput::open(m_fileName));
+    if (!in)
+        return false;
+
+    const OIIO::ImageSpec& spec = in->spec();
+    if (spec.width != static_cast<int>(m_width) ||
+        spec.height != static_cast<int>(m_height) ||
+        spec.nchannels != 4)
+        return false;
+
+    const std::string tileSize = spec.get_string_attribute(TileSizeAttribute);
+    if (tileSize != tileSizeString(m_tileWidth, m_tileHeight).asChar())
+        return false;
+
+    const std::string doneTiles = spec.get_string_attribute(DoneTilesAttribute);
+    if (doneTiles.size() != m_doneTiles.size())
+        return false;
+
+    if (!in->read_image(OIIO::TypeDesc::FLOAT, &m_pixels[0]))
+        return false;
+
+    for (size_t i = 0, e = doneTiles.size(); i < e; ++i)
+        m_doneTiles[i] = doneTiles[i] == '1' ? 1 : 0;
+
+    in->close();
+    return true;
+}
+
+void RenderCheckpoint::write(
+    const std::vector<float>&   pixels,
+    const std::vector<char>&    doneTiles) const
+{
+    // Write to a temporary file first, so that an interrupted
+    // write never replaces a valid checkpoint.
+    const std::string tmpFileName = m_fileName + ".tmp.exr";
+
+    boost::scoped_ptr<OIIO::ImageOutput> out(OIIO::ImageOutput::create(tmpFileName));
+    if (!out)
+    {
+        RENDERER_LOG_ERROR("Could not create render checkpoint %s", m_fileName.c_str());
+        return;
+    }
+
+    std::string doneTilesString(doneTiles.size(), '0');
+    for (size_t i = 0, e = doneTiles.size(); i < e; ++i)
+    {
+        if (doneTiles[i])
+            doneTilesString[i] = '1';
+    }
+
+    OIIO::ImageSpec spec(
+        static_cast<int>(m_width),
+        static_cast<int>(m_height),
+        4,
+        OIIO::TypeDesc::FLOAT);
+    spec.attribute("compression", "zip");
+    spec.attribute(TileSizeAttribute, tileSizeString(m_tileWidth, m_tileHeight).asChar());
+    spec.attribute(DoneTilesAttribute, doneTilesString);
+
+    if (!out->open(tmpFileName, spec) ||
+        !out->write_image(OIIO::TypeDesc::FLOAT, &pixels[0]) ||
+        !out->close())
+    {
+        RENDERER_LOG_ERROR("Could not write render checkpoint %s", m_fileName.c_str());
+        return;
+    }
+
+    boost::system::error_code error;
+    bfs::rename(bfs::path(tmpFileName), bfs::path(m_fileName), error);
+    if (error)
+        RENDERER_LOG_ERROR("Could not write render checkpoint %s", m_fileName.c_str());
+    else
+        RENDERER_LOG_DEBUG("Saved render checkpoint %s", m_fileName.c_str());
+}
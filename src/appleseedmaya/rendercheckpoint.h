@@ -0,0 +1,120 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_MAYA_RENDER_CHECKPOINT_H
+#define APPLESEED_MAYA_RENDER_CHECKPOINT_H
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
+// Maya headers.
+#include <maya/MString.h>
+
+// appleseed.foundation headers.
+#include "foundation/platform/timers.h"
+#include "foundation/utility/stopwatch.h"
+
+// appleseed.maya headers.
+#include "appleseedmaya/utils.h"
+
+// Forward declarations.
+namespace renderer { class Frame; }
+namespace renderer { class ITileCallbackFactory; }
+
+//
+// Periodically saves the finished tiles of a batch render next to the
+// output image, so that an interrupted render can resume from the tiles
+// that were not rendered yet. Only single pass, tile based renders can be
+// checkpointed, as their tiles are final as soon as they are rendered.
+//
+
+class RenderCheckpoint
+  : public NonCopyable
+{
+  public:
+    // interval is the time between checkpoints, in seconds.
+    RenderCheckpoint(const MString& outputFileName, const double interval);
+
+    // Load a previous checkpoint of this frame and restrict the frame crop
+    // window to the rows of tiles not rendered yet. Returns true on resume.
+    bool resume(renderer::Frame& frame);
+
+    // Return true if the checkpoint already contains all the tiles.
+    bool isComplete() const;
+
+    // Return a tile callback factory that records the rendered tiles.
+    renderer::ITileCallbackFactory* createTileCallbackFactory();
+
+    // Called by the tile callbacks when a tile is rendered.
+    void tileRendered(const renderer::Frame& frame, const size_t tileX, const size_t tileY);
+
+    // Copy the tiles restored from the checkpoint back into the frame.
+    void restoreTiles(renderer::Frame& frame) const;
+
+    // Delete the checkpoint file once the image has been written.
+    void remove();
+
+  private:
+    typedef foundation::Stopwatch<foundation::DefaultWallclockTimer> Stopwatch;
+
+    void initialize(const renderer::Frame& frame);
+    void storeTile(const renderer::Frame& frame, const size_t tileX, const size_t tileY);
+    void loadTile(renderer::Frame& frame, const size_t tileX, const size_t tileY) const;
+    bool read();
+    void write(
+        const std::vector<float>&   pixels,
+        const std::vector<char>&    doneTiles) const;
+
+    std::string         m_fileName;
+    double              m_interval;
+    Stopwatch           m_stopwatch;
+    boost::mutex        m_mutex;
+
+    size_t              m_width;
+    size_t              m_height;
+    size_t              m_tileWidth;
+    size_t              m_tileHeight;
+    size_t              m_tileCountX;
+    size_t              m_tileCountY;
+    std::vector<float>  m_pixels;
+    std::vector<char>   m_doneTiles;
+    std::vector<char>   m_restoredTiles;
+    bool                m_complete;
+
+    // Copy of the state being written, owned by the writing thread.
+    bool                m_writing;
+    std::vector<float>  m_writePixels;
+    std::vector<char>   m_writeDoneTiles;
+};
+
+#endif  // !APPLESEED_MAYA_RENDER_CHECKPOINT_H
@@ -0,0 +1,162 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "appleseedmaya/renderercontroller.h"
+
+// Standard headers.
+#include <cmath>
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
+#include "foundation/platform/timers.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/frame.h"
+
+// appleseed.maya headers.
+#include "appleseedmaya/logger.h"
+
+namespace asf = foundation;
+namespace asr = renderer;
+
+RendererController::RendererController()
+  : m_status(ContinueRendering)
+  , m_timeLimit(0.0)
+  , m_startTicks(0)
+  , m_timeLimitReached(false)
+  , m_convergenceThreshold(0.0f)
+  , m_converged(false)
+{
+}
+
+void RendererController::on_rendering_begin()
+{
+    m_converged = false;
+    m_timeLimitReached = false;
+    m_previousLuminance.clear();
+    m_startTicks = asf::DefaultWallclockTimer().read();
+}
+
+asr::IRendererController::Status RendererController::get_status() const
+{
+    const Status status = m_status;
+    if (status != ContinueRendering)
+        return status;
+
+    if (m_converged || m_timeLimitReached)
+        return TerminateRendering;
+
+    if (m_timeLimit > 0.0)
+    {
+        // Only read the clock, get_status is polled from the rendering thread.
+        asf::DefaultWallclockTimer timer;
+        const double seconds =
+            static_cast<double>(timer.read() - m_startTicks) / timer.frequency();
+
+        if (seconds >= m_timeLimit)
+        {
+            // Several threads can poll the status at the same time, log only once.
+            if (!m_timeLimitReached.exchange(true))
+                RENDERER_LOG_INFO("Render time limit reached, stopping render");
+
+            return TerminateRendering;
+        }
+    }
+
+    return ContinueRendering;
+}
+
+void RendererController::set_status(Status status)
+{
+    m_status = status;
+}
+
+void RendererController::setTimeLimit(const double seconds)
+{
+    m_timeLimit = seconds;
+}
+
+void RendererController::setConvergenceThreshold(const float threshold)
+{
+    m_convergenceThreshold = threshold;
+}
+
+void RendererController::frameUpdated(const asr::Frame& frame)
+{
+    if (m_convergenceThreshold <= 0.0f || m_converged)
+        return;
+
+    const asf::Image& image = frame.image();
+    const asf::CanvasProperties& props = image.properties();
+
+    std::vector<float> luminance;
+    luminance.reserve(props.m_pixel_count);
+
+    for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+    {
+        for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
+        {
+            const asf::Tile& tile = image.tile(tx, ty);
+
+            for (size_t y = 0, ye = tile.get_height(); y < ye; ++y)
+            {
+                for (size_t x = 0, xe = tile.get_width(); x < xe; ++x)
+                {
+                    asf::Color4f color;
+                    tile.get_pixel(x, y, color);
+                    luminance.push_back(asf::luminance(color.rgb()));
+                }
+            }
+        }
+    }
+
+    if (m_previousLuminance.size() == luminance.size())
+    {
+        // Mean relative change of the image since the previous update.
+        double difference = 0.0;
+        double total = 0.0;
+        for (size_t i = 0, e = luminance.size(); i < e; ++i)
+        {
+            difference += std::abs(luminance[i] - m_previousLuminance[i]);
+            total += std::abs(m_previousLuminance[i]);
+        }
+
+        if (total > 0.0 && difference / total < m_convergenceThreshold)
+        {
+            if (!m_converged.exchange(true))
+                RENDERER_LOG_INFO("Render converged, stopping render");
+        }
+    }
+
+    m_previousLuminance.swap(luminance);
+}
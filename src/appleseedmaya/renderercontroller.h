@@ -29,31 +29,53 @@
 #ifndef APPLESEED_MAYA_RENDERER_CONTROLLER_H
 #define APPLESEED_MAYA_RENDERER_CONTROLLER_H
 
+// Standard headers.
+#include <vector>
+
+// Boost headers.
+#include "boost/atomic.hpp"
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
 // appleseed.renderer headers.
 #include "renderer/api/rendering.h"
 
+// Forward declarations.
+namespace renderer { class Frame; }
+
 class RendererController
   : public renderer::DefaultRendererController
 {
   public:
 
-    RendererController()
-    {
-        m_status = ContinueRendering;
-    }
+    RendererController();
+
+    virtual void on_rendering_begin();
+
+    virtual Status get_status() const;
+
+    void set_status(Status status);
+
+    // Stop rendering after a number of seconds. 0 means no limit.
+    void setTimeLimit(const double seconds);
 
-    virtual Status get_status() const
-    {
-        return m_status;
-    }
+    // Stop rendering when the image changes less than threshold
+    // between two progressive updates. 0 disables the test.
+    void setConvergenceThreshold(const float threshold);
 
-    void set_status(Status status)
-    {
-        m_status = status;
-    }
+    // Called by tile callbacks each time the whole frame is updated.
+    void frameUpdated(const renderer::Frame& frame);
 
   private:
-    Status m_status;
+    // Status and convergence are set from the UI and tile callback threads.
+    boost::atomic<Status>           m_status;
+    double                          m_timeLimit;
+    foundation::uint64              m_startTicks;
+    mutable boost::atomic<bool>     m_timeLimitReached;
+    float                           m_convergenceThreshold;
+    boost::atomic<bool>             m_converged;
+    std::vector<float>              m_previousLuminance;
 };
 
 #endif  // !APPLESEED_MAYA_RENDERER_CONTROLLER_H
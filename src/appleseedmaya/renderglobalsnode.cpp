@@ -29,6 +29,10 @@
 // Interface header.
 #include "appleseedmaya/renderglobalsnode.h"
 
+// Standard headers.
+#include <algorithm>
+#include <cmath>
+
 // Maya headers.
 #include <maya/MAnimControl.h>
 #include <maya/MFnDependencyNode.h>
@@ -58,8 +62,18 @@ const MTypeId RenderGlobalsNode::id(RenderGlobalsNodeTypeId);
 
 MObject RenderGlobalsNode::m_pixelSamples;
 MObject RenderGlobalsNode::m_passes;
+MObject RenderGlobalsNode::m_pixelSampler;
+MObject RenderGlobalsNode::m_minPixelSamples;
+MObject RenderGlobalsNode::m_maxPixelSamples;
+MObject RenderGlobalsNode::m_noiseThreshold;
 MObject RenderGlobalsNode::m_tileSize;
 
+MObject RenderGlobalsNode::m_progressiveRender;
+MObject RenderGlobalsNode::m_timeLimit;
+MObject RenderGlobalsNode::m_progressiveMaxSamples;
+MObject RenderGlobalsNode::m_convergenceThreshold;
+MObject RenderGlobalsNode::m_checkpointInterval;
+
 MObject RenderGlobalsNode::m_lightingEngine;
 
 MStringArray RenderGlobalsNode::m_diagnosticShaderKeys;
@@ -86,6 +100,8 @@ MObject RenderGlobalsNode::m_shutterOpen;
 MObject RenderGlobalsNode::m_shutterClose;
 
 MObject RenderGlobalsNode::m_renderingThreads;
+MObject RenderGlobalsNode::m_convertTextures;
+MObject RenderGlobalsNode::m_renderInSeparateProcess;
 
 MObject RenderGlobalsNode::m_imageFormat;
 
@@ -97,6 +113,7 @@ void* RenderGlobalsNode::creator()
 MStatus RenderGlobalsNode::initialize()
 {
     MFnNumericAttribute numAttrFn;
+    MFnEnumAttribute enumAttrFn;
     MFnMessageAttribute msgAttrFn;
 
     MStatus status;
@@ -125,6 +142,57 @@ MStatus RenderGlobalsNode::initialize()
         status,
         "appleseedMaya: Failed to add render globals passes attribute");
 
+    // Pixel sampler.
+    m_pixelSampler = enumAttrFn.create("pixelSampler", "pixelSampler", 0, &status);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to create render globals pixelSampler attribute");
+
+    enumAttrFn.addField("Uniform", 0);
+    enumAttrFn.addField("Adaptive", 1);
+
+    status = addAttribute(m_pixelSampler);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to add render globals pixelSampler attribute");
+
+    // Adaptive Min Samples.
+    m_minPixelSamples = numAttrFn.create("minPixelSamples", "minPixelSamples", MFnNumericData::kInt, 16, &status);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to create render globals minPixelSamples attribute");
+
+    numAttrFn.setMin(1);
+    status = addAttribute(m_minPixelSamples);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to add render globals minPixelSamples attribute");
+
+    // Adaptive Max Samples.
+    m_maxPixelSamples = numAttrFn.create("maxPixelSamples", "maxPixelSamples", MFnNumericData::kInt, 256, &status);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to create render globals maxPixelSamples attribute");
+
+    numAttrFn.setMin(1);
+    status = addAttribute(m_maxPixelSamples);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to add render globals maxPixelSamples attribute");
+
+    // Adaptive Noise Threshold.
+    m_noiseThreshold = numAttrFn.create("noiseThreshold", "noiseThreshold", MFnNumericData::kFloat, 0.01f, &status);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to create render globals noiseThreshold attribute");
+
+    numAttrFn.setMin(0.0001f);
+    numAttrFn.setMax(1.0f);
+    status = addAttribute(m_noiseThreshold);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to add render globals noiseThreshold attribute");
+
     // Tile Size.
     m_tileSize = numAttrFn.create("tileSize", "tileSize", MFnNumericData::kInt, 64, &status);
     APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
@@ -137,8 +205,67 @@ MStatus RenderGlobalsNode::initialize()
         status,
         "appleseedMaya: Failed to add render globals tileSize attribute");
 
+    // Progressive final render.
+    m_progressiveRender = numAttrFn.create("progressiveRender", "progressiveRender", MFnNumericData::kBoolean, false, &status);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to create render globals progressiveRender attribute");
+
+    status = addAttribute(m_progressiveRender);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to add render globals progressiveRender attribute");
+
+    // Time Limit, in minutes.
+    m_timeLimit = numAttrFn.create("timeLimit", "timeLimit", MFnNumericData::kFloat, 0.0f, &status);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to create render globals timeLimit attribute");
+
+    numAttrFn.setMin(0.0f);
+    status = addAttribute(m_timeLimit);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to add render globals timeLimit attribute");
+
+    // Progressive Max Samples per pixel.
+    m_progressiveMaxSamples = numAttrFn.create("progressiveMaxSamples", "progressiveMaxSamples", MFnNumericData::kInt, 0, &status);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to create render globals progressiveMaxSamples attribute");
+
+    numAttrFn.setMin(0);
+    status = addAttribute(m_progressiveMaxSamples);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to add render globals progressiveMaxSamples attribute");
+
+    // Convergence Threshold.
+    m_convergenceThreshold = numAttrFn.create("convergenceThreshold", "convergenceThreshold", MFnNumericData::kFloat, 0.0f, &status);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to create render globals convergenceThreshold attribute");
+
+    numAttrFn.setMin(0.0f);
+    numAttrFn.setMax(1.0f);
+    status = addAttribute(m_convergenceThreshold);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to add render globals convergenceThreshold attribute");
+
+    // Checkpoint Interval, in minutes.
+    m_checkpointInterval = numAttrFn.create("checkpointInterval", "checkpointInterval", MFnNumericData::kFloat, 0.0f, &status);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to create render globals checkpointInterval attribute");
+
+    numAttrFn.setMin(0.0f);
+    status = addAttribute(m_checkpointInterval);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to add render globals checkpointInterval attribute");
+
     // Lighting engine.
-    MFnEnumAttribute enumAttrFn;
     m_lightingEngine = enumAttrFn.create("lightingEngine", "lightingEngine", 0, &status);
     APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
         status,
@@ -370,6 +497,28 @@ MStatus RenderGlobalsNode::initialize()
         status,
         "appleseedMaya: Failed to add render globals threads attribute");
 
+    // Texture conversion. Off by default, existing scenes keep rendering their textures as is.
+    m_convertTextures = numAttrFn.create("convertTextures", "convertTextures", MFnNumericData::kBoolean, false, &status);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to create render globals convertTextures attribute");
+
+    status = addAttribute(m_convertTextures);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to add render globals convertTextures attribute");
+
+    // Render in a separate process.
+    m_renderInSeparateProcess = numAttrFn.create("renderInSeparateProcess", "renderInSeparateProcess", MFnNumericData::kBoolean, false, &status);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to create render globals renderInSeparateProcess attribute");
+
+    status = addAttribute(m_renderInSeparateProcess);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: Failed to add render globals renderInSeparateProcess attribute");
+
     // Environment light connection.
     m_envLightNode = msgAttrFn.create("envLight", "env", &status);
     APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
@@ -407,14 +556,55 @@ void RenderGlobalsNode::applyGlobalsToProject(
     asr::ParamArray& finalParams = project.configurations().get_by_name("final")->get_parameters();
     asr::ParamArray& iprParams   = project.configurations().get_by_name("interactive")->get_parameters();
 
-    int samples;
-    if (AttributeUtils::get(MPlug(globals, m_pixelSamples), samples))
+    int pixelSampler = 0;
+    AttributeUtils::get(MPlug(globals, m_pixelSampler), pixelSampler);
+
+    if (pixelSampler == 0)
     {
-        finalParams.insert_path("uniform_pixel_renderer.samples", samples);
+        finalParams.insert_path("pixel_renderer", "uniform");
 
-        if (samples == 1)
-            finalParams.insert_path("uniform_pixel_renderer.force_antialiasing", true);
+        int samples;
+        if (AttributeUtils::get(MPlug(globals, m_pixelSamples), samples))
+        {
+            finalParams.insert_path("uniform_pixel_renderer.samples", samples);
+
+            if (samples == 1)
+                finalParams.insert_path("uniform_pixel_renderer.force_antialiasing", true);
+        }
     }
+    else
+    {
+        finalParams.insert_path("pixel_renderer", "adaptive");
+
+        int minSamples = 16;
+        AttributeUtils::get(MPlug(globals, m_minPixelSamples), minSamples);
+
+        int maxSamples = 256;
+        AttributeUtils::get(MPlug(globals, m_maxPixelSamples), maxSamples);
+
+        finalParams.insert_path("adaptive_pixel_renderer.min_samples", minSamples);
+        finalParams.insert_path("adaptive_pixel_renderer.max_samples", std::max(minSamples, maxSamples));
+
+        // appleseed stops sampling a pixel when its variation falls below 10^-quality.
+        float noiseThreshold = 0.01f;
+        if (AttributeUtils::get(MPlug(globals, m_noiseThreshold), noiseThreshold))
+        {
+            const float quality = -std::log10(std::max(noiseThreshold, 0.0001f));
+            finalParams.insert_path("adaptive_pixel_renderer.quality", quality);
+        }
+    }
+
+    bool progressiveRender = false;
+    AttributeUtils::get(MPlug(globals, m_progressiveRender), progressiveRender);
+
+    if (progressiveRender)
+    {
+        // Sample caps depend on the resolution and are set by the session.
+        finalParams.insert_path("frame_renderer", "progressive");
+        finalParams.insert_path("progressive_frame_renderer.max_fps", 2);
+    }
+    else
+        finalParams.insert_path("frame_renderer", "generic");
 
     int passes;
     if (AttributeUtils::get(MPlug(globals, m_passes), passes))
@@ -64,8 +64,18 @@ class RenderGlobalsNode
   private:
     static MObject m_pixelSamples;
     static MObject m_passes;
+    static MObject m_pixelSampler;
+    static MObject m_minPixelSamples;
+    static MObject m_maxPixelSamples;
+    static MObject m_noiseThreshold;
     static MObject m_tileSize;
 
+    static MObject m_progressiveRender;
+    static MObject m_timeLimit;
+    static MObject m_progressiveMaxSamples;
+    static MObject m_convergenceThreshold;
+    static MObject m_checkpointInterval;
+
     static MObject m_lightingEngine;
 
     static MObject      m_diagnosticShader;
@@ -93,6 +103,8 @@ class RenderGlobalsNode
     static MObject m_shutterClose;
 
     static MObject m_renderingThreads;
+    static MObject m_convertTextures;
+    static MObject m_renderInSeparateProcess;
 
     static MObject m_imageFormat;
 };
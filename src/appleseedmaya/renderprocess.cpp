@@ -0,0 +1,425 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "appleseedmaya/renderprocess.h"
+
+// Standard headers.
+#include <string>
+#include <vector>
+
+// Boost headers.
+#include "boost/thread/locks.hpp"
+
+// Platform headers.
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/string.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/frame.h"
+#include "renderer/api/rendering.h"
+
+// appleseed.maya headers.
+#include "appleseedmaya/logger.h"
+#include "appleseedmaya/renderprocessprotocol.h"
+
+#ifndef _WIN32
+extern char** environ;
+#endif
+
+namespace asf = foundation;
+namespace asr = renderer;
+
+using namespace RenderProcessProtocol;
+
+RenderProcess::RenderProcess(
+    RendererController&     rendererController,
+    asr::Frame&             frame,
+    asr::ITileCallback*     tileCallback)
+  : m_rendererController(rendererController)
+  , m_frame(frame)
+  , m_tileCallback(tileCallback)
+  , m_completed(false)
+  , m_terminated(false)
+  , m_pid(-1)
+  , m_stdin(-1)
+  , m_stdout(-1)
+{
+}
+
+RenderProcess::~RenderProcess()
+{
+    abort();
+    wait();
+
+    if (m_tileCallback)
+        m_tileCallback->release();
+}
+
+#ifndef _WIN32
+
+bool RenderProcess::start(
+    const MString&          executable,
+    const MString&          projectFileName,
+    const MString&          schemaFileName,
+    const size_t            numThreads)
+{
+    int stdinPipe[2];
+    int stdoutPipe[2];
+
+    if (pipe(stdinPipe) != 0)
+    {
+        RENDERER_LOG_ERROR("Could not create render process pipes");
+        return false;
+    }
+
+    if (pipe(stdoutPipe) != 0)
+    {
+        close(stdinPipe[0]);
+        close(stdinPipe[1]);
+        RENDERER_LOG_ERROR("Could not create render process pipes");
+        return false;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, stdinPipe[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, stdoutPipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, stdinPipe[1]);
+    posix_spawn_file_actions_addclose(&actions, stdoutPipe[0]);
+
+    const std::string exe = executable.asChar();
+    const std::string threads = asf::to_string(numThreads);
+    const std::string schema = schemaFileName.asChar();
+    const std::string project = projectFileName.asChar();
+
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(exe.c_str()));
+    argv.push_back(const_cast<char*>("--threads"));
+    argv.push_back(const_cast<char*>(threads.c_str()));
+    argv.push_back(const_cast<char*>("--schema"));
+    argv.push_back(const_cast<char*>(schema.c_str()));
+    argv.push_back(const_cast<char*>(project.c_str()));
+    argv.push_back(0);
+
+    pid_t pid;
+    const int error = posix_spawn(&pid, exe.c_str(), &actions, 0, &argv[0], environ);
+    posix_spawn_file_actions_destroy(&actions);
+
+    close(stdinPipe[0]);
+    close(stdoutPipe[1]);
+
+    if (error != 0)
+    {
+        close(stdinPipe[1]);
+        close(stdoutPipe[0]);
+        RENDERER_LOG_ERROR("Could not start render process %s", exe.c_str());
+        return false;
+    }
+
+    m_pid = pid;
+    m_stdin = stdinPipe[1];
+    m_stdout = stdoutPipe[0];
+
+    RENDERER_LOG_INFO("Started render process %s", exe.c_str());
+
+    // The master renderer does this for in process renders;
+    // it starts the time limit and resets the convergence test.
+    m_rendererController.on_rendering_begin();
+
+    boost::thread thread(&RenderProcess::readMessages, this);
+    m_readerThread.swap(thread);
+    return true;
+}
+
+bool RenderProcess::wait()
+{
+    if (m_readerThread.joinable())
+        m_readerThread.join();
+
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    closeStdin();
+
+    if (m_stdout != -1)
+    {
+        close(m_stdout);
+        m_stdout = -1;
+    }
+
+    if (m_pid != -1)
+    {
+        int status;
+        while (waitpid(m_pid, &status, 0) == -1 && errno == EINTR)
+        {
+        }
+
+        m_pid = -1;
+    }
+
+    return m_completed;
+}
+
+void RenderProcess::terminate()
+{
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    if (m_stdin == -1 || m_terminated)
+        return;
+
+    // Writing to a process that already exited fails with EPIPE,
+    // SIGPIPE is blocked in the reader thread.
+    ssize_t n;
+    while ((n = ::write(m_stdin, &TerminateCommand, 1)) == -1 && errno == EINTR)
+    {
+    }
+
+    m_terminated = true;
+}
+
+void RenderProcess::abort()
+{
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    // Closing its stdin makes the render process abort.
+    closeStdin();
+
+    if (m_pid != -1)
+        kill(m_pid, SIGTERM);
+}
+
+bool RenderProcess::read(void* data, const size_t size)
+{
+    char* p = static_cast<char*>(data);
+    size_t remaining = size;
+
+    while (remaining != 0)
+    {
+        // Wait for data with a timeout, so that the renderer controller
+        // is checked even when the render process is not sending anything.
+        pollfd fd;
+        fd.fd = m_stdout;
+        fd.events = POLLIN;
+        fd.revents = 0;
+
+        const int ready = poll(&fd, 1, 100);
+
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        if (ready == 0)
+        {
+            if (!checkStatus())
+                return false;
+
+            continue;
+        }
+
+        const ssize_t n = ::read(m_stdout, p, remaining);
+
+        if (n == 0)
+            return false;
+
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        p += n;
+        remaining -= n;
+    }
+
+    return true;
+}
+
+void RenderProcess::closeStdin()
+{
+    if (m_stdin != -1)
+    {
+        close(m_stdin);
+        m_stdin = -1;
+    }
+}
+
+#else
+
+bool RenderProcess::start(
+    const MString&          executable,
+    const MString&          projectFileName,
+    const MString&          schemaFileName,
+    const size_t            numThreads)
+{
+    RENDERER_LOG_ERROR("Rendering in a separate process is not supported on this platform");
+    return false;
+}
+
+bool RenderProcess::wait()
+{
+    return m_completed;
+}
+
+void RenderProcess::terminate()
+{
+}
+
+void RenderProcess::abort()
+{
+}
+
+bool RenderProcess::read(void* data, const size_t size)
+{
+    return false;
+}
+
+void RenderProcess::closeStdin()
+{
+}
+
+#endif
+
+bool RenderProcess::checkStatus()
+{
+    const asr::IRendererController::Status status = m_rendererController.get_status();
+
+    if (status == asr::IRendererController::ContinueRendering)
+        return true;
+
+    // Time and convergence limits end the render normally.
+    if (status == asr::IRendererController::TerminateRendering)
+    {
+        terminate();
+        return true;
+    }
+
+    abort();
+    return false;
+}
+
+void RenderProcess::readMessages()
+{
+#ifndef _WIN32
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &signals, 0);
+#endif
+
+    const asf::CanvasProperties& props = m_frame.image().properties();
+    std::vector<char> payload;
+
+    MessageHeader header;
+    while (read(&header, sizeof(header)))
+    {
+        payload.resize(header.m_size);
+        if (header.m_size != 0 && !read(&payload[0], header.m_size))
+            break;
+
+        if (!checkStatus())
+            break;
+
+        const boost::uint32_t* values =
+            payload.empty() ? 0 : reinterpret_cast<const boost::uint32_t*>(&payload[0]);
+
+        if (header.m_type == FrameBeginMessage && header.m_size >= 4 * sizeof(boost::uint32_t))
+        {
+            if (values[0] != props.m_canvas_width  ||
+                values[1] != props.m_canvas_height ||
+                values[2] != props.m_tile_width    ||
+                values[3] != props.m_tile_height)
+            {
+                RENDERER_LOG_ERROR("Render process frame does not match the exported frame");
+                abort();
+                break;
+            }
+        }
+        else if (header.m_type == TileHighlightMessage && header.m_size >= 4 * sizeof(boost::uint32_t))
+        {
+            if (m_tileCallback)
+                m_tileCallback->pre_render(values[0], values[1], values[2], values[3]);
+        }
+        else if (header.m_type == TileMessage && header.m_size >= 4 * sizeof(boost::uint32_t))
+        {
+            const size_t tileX = values[0];
+            const size_t tileY = values[1];
+
+            if (tileX >= props.m_tile_count_x || tileY >= props.m_tile_count_y)
+                continue;
+
+            asf::Tile& tile = m_frame.image().tile(tileX, tileY);
+            const size_t width = values[2];
+            const size_t height = values[3];
+
+            if (width != tile.get_width() ||
+                height != tile.get_height() ||
+                header.m_size != 4 * sizeof(boost::uint32_t) + width * height * 4 * sizeof(float))
+                continue;
+
+            const float* src = reinterpret_cast<const float*>(values + 4);
+            for (size_t y = 0; y < height; ++y)
+            {
+                for (size_t x = 0; x < width; ++x)
+                {
+                    for (size_t c = 0; c < 4; ++c)
+                        tile.set_component(x, y, c, *src++);
+                }
+            }
+
+            if (m_tileCallback)
+                m_tileCallback->post_render_tile(&m_frame, tileX, tileY);
+        }
+        else if (header.m_type == FrameUpdatedMessage)
+        {
+            // Lets the tile callback update the whole frame and test convergence.
+            if (m_tileCallback)
+                m_tileCallback->post_render(&m_frame);
+        }
+        else if (header.m_type == FrameEndMessage && header.m_size >= sizeof(boost::uint32_t))
+            m_completed = values[0] == 0;
+    }
+}
@@ -0,0 +1,106 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_MAYA_RENDER_PROCESS_H
+#define APPLESEED_MAYA_RENDER_PROCESS_H
+
+// Standard headers.
+#include <cstddef>
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+
+// Maya headers.
+#include <maya/MString.h>
+
+// appleseed.maya headers.
+#include "appleseedmaya/renderercontroller.h"
+#include "appleseedmaya/utils.h"
+
+// Forward declarations.
+namespace renderer { class Frame; }
+namespace renderer { class ITileCallback; }
+
+//
+// Renders a project file in a separate appleseedMayaRender process.
+// The tiles streamed back by the process are copied into a frame with the
+// same layout and passed to a tile callback, as if rendered in process.
+//
+
+class RenderProcess
+  : public NonCopyable
+{
+  public:
+    RenderProcess(
+        RendererController&         rendererController,
+        renderer::Frame&            frame,
+        renderer::ITileCallback*    tileCallback);
+
+    ~RenderProcess();
+
+    // Launch the render process. Returns false if it could not be started.
+    bool start(
+        const MString&              executable,
+        const MString&              projectFileName,
+        const MString&              schemaFileName,
+        const size_t                numThreads);
+
+    // Wait until the render process exits. Returns true if the render completed.
+    bool wait();
+
+    // Ask the render process to stop, keeping the tiles rendered so far.
+    void terminate();
+
+    // Stop the render process.
+    void abort();
+
+  private:
+    void readMessages();
+    bool read(void* data, const size_t size);
+
+    // Forward the status of the renderer controller to the render process.
+    // Returns false if the render was aborted.
+    bool checkStatus();
+
+    // Must be called with m_mutex locked.
+    void closeStdin();
+
+    RendererController&         m_rendererController;
+    renderer::Frame&            m_frame;
+    renderer::ITileCallback*    m_tileCallback;
+    boost::thread               m_readerThread;
+    boost::mutex                m_mutex;
+    bool                        m_completed;
+    bool                        m_terminated;
+    int                         m_pid;
+    int                         m_stdin;
+    int                         m_stdout;
+};
+
+#endif  // !APPLESEED_MAYA_RENDER_PROCESS_H
@@ -0,0 +1,75 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_MAYA_RENDER_PROCESS_PROTOCOL_H
+#define APPLESEED_MAYA_RENDER_PROCESS_PROTOCOL_H
+
+// Boost headers.
+#include "boost/cstdint.hpp"
+
+//
+// Messages sent by the appleseedMayaRender process on its standard output.
+// Each message is a MessageHeader followed by size bytes of payload, made of
+// native endian 32 bit unsigned integers and, for tiles, 32 bit floats.
+// The render process stops and sends its last tiles when it reads
+// TerminateCommand on its standard input, and aborts when it is closed.
+//
+
+namespace RenderProcessProtocol
+{
+
+enum MessageType
+{
+    // width, height, tile width, tile height.
+    FrameBeginMessage = 1,
+
+    // x, y, width, height of a tile about to be rendered, in pixels.
+    TileHighlightMessage = 2,
+
+    // tile x, tile y, width, height, followed by width * height RGBA float pixels.
+    TileMessage = 3,
+
+    // status: 0 if the render completed, 1 otherwise.
+    FrameEndMessage = 4,
+
+    // No payload. Sent after the tiles of a whole frame or pass were sent.
+    FrameUpdatedMessage = 5
+};
+
+// Sent by the Maya plugin on the standard input of the render process.
+const char TerminateCommand = 't';
+
+struct MessageHeader
+{
+    boost::uint32_t m_type;
+    boost::uint32_t m_size;
+};
+
+} // RenderProcessProtocol
+
+#endif  // !APPLESEED_MAYA_RENDER_PROCESS_PROTOCOL_H
@@ -121,6 +121,8 @@ class RenderViewTileCallback
         for( size_t ty = 0; ty < frame_props.m_tile_count_y; ++ty )
             for( size_t tx = 0; tx < frame_props.m_tile_count_x; ++tx )
                 write_tile(frame, tx, ty);
+
+        m_rendererController.frameUpdated(*frame);
     }
 
     virtual void post_render_tile(
@@ -58,6 +58,7 @@
 
 // appleseed.maya headers.
 #include "appleseedmaya/logger.h"
+#include "appleseedmaya/threadbudget.h"
 #include "appleseedmaya/utils.h"
 
 namespace asf = foundation;
@@ -66,6 +67,42 @@ namespace asr = renderer;
 namespace
 {
 
+// Stops swatch renders when a final or IPR render needs their threads.
+class SwatchRendererController
+  : public asr::DefaultRendererController
+{
+  public:
+
+    SwatchRendererController()
+      : m_yielded(false)
+    {
+    }
+
+    virtual void on_rendering_begin()
+    {
+        m_yielded = false;
+    }
+
+    virtual Status get_status() const
+    {
+        if (ThreadBudget::yieldRequested())
+        {
+            m_yielded = true;
+            return AbortRendering;
+        }
+
+        return ContinueRendering;
+    }
+
+    bool yielded() const
+    {
+        return m_yielded;
+    }
+
+  private:
+    mutable bool m_yielded;
+};
+
 class SwatchProject
   : public NonCopyable
 {
@@ -82,8 +119,6 @@ class SwatchProject
         m_project = asr::ProjectFactory::create("project");
         m_project->add_default_configurations();
 
-        const size_t NumThreads = 2;
-
         // Insert some config params needed by the final renderer.
         asr::Configuration* cfg = m_project->configurations().get_by_name("final");
         asr::ParamArray* cfg_params = &cfg->get_parameters();
@@ -95,7 +130,6 @@ class SwatchProject
         cfg_params->insert("pixel_renderer", "uniform");
         cfg_params->insert("sampling_mode", "qmc");
         cfg_params->insert_path("uniform_pixel_renderer.samples", "4");
-        cfg_params->insert("rendering_threads", NumThreads);
 
         // While testing.
         cfg_params->insert_path("shading_engine.override_shading.mode", "uv");
@@ -251,7 +285,8 @@ class SwatchProject
         m_material->get_parameters().remove_path("osl_surface");
     }
 
-    void render(const size_t resolution, MImage& dstImage)
+    // Returns false if the swatch could not be rendered now and should be retried.
+    bool render(const size_t resolution, MImage& dstImage)
     {
         // Disable logging while rendering the swatch.
         ScopedSetLoggerVerbosity logLevel(asf::LogMessage::Error);
@@ -262,9 +297,21 @@ class SwatchProject
         asf::auto_release_ptr<asr::Frame> frame(asr::FrameFactory::create("beauty", frameParams));
         m_project->set_frame(frame);
 
+        // Swatches share the rendering threads with the final and IPR renders.
+        const size_t MaxSwatchThreads = 2;
+        ThreadBudget::ScopedReservation threads(ThreadBudget::LowPriority, MaxSwatchThreads);
+        if (threads.numThreads() == 0)
+            return false;
+
+        m_renderer->get_parameters().insert("rendering_threads", threads.numThreads());
+
         // Render.
         m_renderer->render();
+        if (m_rendererController.yielded())
+            return false;
+
         copySwatchImage(dstImage);
+        return true;
     }
 
   private:
@@ -311,7 +358,7 @@ class SwatchProject
     asr::Assembly*                      m_mainAssembly;
     asr::Material*                      m_material;
     asr::MasterRenderer*                m_renderer;
-    asr::DefaultRendererController      m_rendererController;
+    SwatchRendererController            m_rendererController;
 };
 
 SwatchProject g_materialSwatchProject;
@@ -392,7 +439,7 @@ bool SwatchRenderer::doIteration()
         g_textureSwatchProject.removeAllShaderGroups();
 
         // todo: export node() here...
-        g_textureSwatchProject.render(resolution(), image());
+        return g_textureSwatchProject.render(resolution(), image());
     }
     else
     {
@@ -400,8 +447,6 @@ bool SwatchRenderer::doIteration()
         g_materialSwatchProject.removeAllShaderGroups();
 
         // todo: export node() here...
-        g_materialSwatchProject.render(resolution(), image());
+        return g_materialSwatchProject.render(resolution(), image());
     }
-
-    return true;
 }
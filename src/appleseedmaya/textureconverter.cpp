@@ -0,0 +1,365 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "appleseedmaya/textureconverter.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <set>
+#include <sstream>
+#include <string>
+
+// Boost headers.
+#include "boost/bind.hpp"
+#include "boost/filesystem/convenience.hpp"
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+
+// OpenImageIO headers.
+#include "OpenImageIO/imagebufalgo.h"
+#include "OpenImageIO/imageio.h"
+
+// Maya headers.
+#include <maya/MStatus.h>
+
+// appleseed.maya headers.
+#include "appleseedmaya/logger.h"
+#include "appleseedmaya/murmurhash.h"
+
+namespace bfs = boost::filesystem;
+
+namespace
+{
+
+// Bump when the conversion settings change, to invalidate cached files.
+const int CacheVersion = 1;
+
+struct ConversionJob
+{
+    std::string m_source;
+    std::string m_destination;
+};
+
+class ConverterPool
+{
+  public:
+    ConverterPool()
+      : m_numActiveJobs(0)
+      , m_stopping(false)
+    {
+    }
+
+    ~ConverterPool()
+    {
+        stop();
+    }
+
+    void push(const ConversionJob& job)
+    {
+        {
+            boost::lock_guard<boost::mutex> lock(m_mutex);
+
+            // Start the workers the first time they are needed.
+            if (m_threads.size() == 0)
+            {
+                const size_t numThreads = std::max(boost::thread::hardware_concurrency(), 1u);
+                for (size_t i = 0; i < numThreads; ++i)
+                    m_threads.create_thread(boost::bind(&ConverterPool::run, this));
+            }
+
+            m_jobs.push_back(job);
+        }
+
+        m_jobAvailable.notify_one();
+    }
+
+    void wait()
+    {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        while (!m_jobs.empty() || m_numActiveJobs != 0)
+            m_jobDone.wait(lock);
+    }
+
+    // Drop the queued jobs and wait for the running ones to finish.
+    void cancel()
+    {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        m_jobs.clear();
+
+        while (m_numActiveJobs != 0)
+            m_jobDone.wait(lock);
+    }
+
+    void stop()
+    {
+        {
+            boost::lock_guard<boost::mutex> lock(m_mutex);
+            m_stopping = true;
+            m_jobs.clear();
+        }
+
+        m_jobAvailable.notify_all();
+        m_threads.join_all();
+    }
+
+  private:
+    void run()
+    {
+        while (true)
+        {
+            ConversionJob job;
+
+            {
+                boost::unique_lock<boost::mutex> lock(m_mutex);
+                while (m_jobs.empty() && !m_stopping)
+                    m_jobAvailable.wait(lock);
+
+                if (m_stopping)
+                    return;
+
+                job = m_jobs.front();
+                m_jobs.pop_front();
+                ++m_numActiveJobs;
+            }
+
+            convert(job);
+
+            {
+                boost::lock_guard<boost::mutex> lock(m_mutex);
+                --m_numActiveJobs;
+            }
+
+            m_jobDone.notify_all();
+        }
+    }
+
+    static void convert(const ConversionJob& job)
+    {
+        // Write to a uniquely named temporary file and rename it, so that
+        // other sessions sharing the cache never see partially written files
+        // or write to the same temporary file. Keep the .tx extension, as
+        // OpenImageIO picks the output format from it.
+        const bfs::path destination(job.m_destination);
+        const std::string tmpFileName =
+            bfs::unique_path(
+                destination.parent_path() /
+                (destination.stem().string() + "-%%%%-%%%%-%%%%.tmp.tx")).string();
+
+        OIIO::ImageSpec config;
+        config.tile_width = 64;
+        config.tile_height = 64;
+        config.tile_depth = 1;
+        config.attribute("maketx:updatemode", 1);
+
+        std::stringstream errors;
+        const bool converted = OIIO::ImageBufAlgo::make_texture(
+            OIIO::ImageBufAlgo::MakeTxTexture,
+            job.m_source,
+            tmpFileName,
+            config,
+            &errors);
+
+        boost::system::error_code ec;
+        if (converted)
+            bfs::rename(tmpFileName, job.m_destination, ec);
+
+        if (!converted || ec)
+        {
+            // The scene already references the converted file name.
+            // OpenImageIO does not rely on file extensions,
+            // so a copy of the source texture works as a fallback.
+            RENDERER_LOG_WARNING(
+                "Couldn't convert texture %s: %s",
+                job.m_source.c_str(),
+                errors.str().c_str());
+
+            bfs::remove(tmpFileName, ec);
+            bfs::copy_file(job.m_source, job.m_destination, bfs::copy_option::overwrite_if_exists, ec);
+        }
+        else
+        {
+            RENDERER_LOG_DEBUG(
+                "Converted texture %s to %s",
+                job.m_source.c_str(),
+                job.m_destination.c_str());
+        }
+    }
+
+    boost::mutex                m_mutex;
+    boost::condition_variable   m_jobAvailable;
+    boost::condition_variable   m_jobDone;
+    std::deque<ConversionJob>   m_jobs;
+    size_t                      m_numActiveJobs;
+    bool                        m_stopping;
+    boost::thread_group         m_threads;
+};
+
+ConverterPool* g_pool = 0;
+bool g_active = false;
+bfs::path g_cacheDirectory;
+bfs::path g_referenceDirectory;
+std::set<std::string> g_queuedFiles;
+
+bool isConvertible(const bfs::path& p)
+{
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    // Already tiled and mipmapped.
+    if (ext == ".tx")
+        return false;
+
+    // Texture sequences and UDIM patterns are resolved by the shaders.
+    if (p.string().find_first_of("<#") != std::string::npos)
+        return false;
+
+    return true;
+}
+
+} // unnamed.
+
+namespace TextureConverter
+{
+
+MStatus initialize()
+{
+    g_pool = new ConverterPool();
+    RENDERER_LOG_INFO("Initialized texture converter");
+    return MS::kSuccess;
+}
+
+MStatus uninitialize()
+{
+    delete g_pool;
+    g_pool = 0;
+    RENDERER_LOG_INFO("Uninitialized texture converter");
+    return MS::kSuccess;
+}
+
+void begin(const MString& cacheDirectory, const MString& referenceDirectory)
+{
+    g_cacheDirectory = cacheDirectory.asChar();
+    g_referenceDirectory = referenceDirectory.asChar();
+
+    boost::system::error_code ec;
+    if (!bfs::exists(g_cacheDirectory))
+        bfs::create_directories(g_cacheDirectory, ec);
+
+    if (ec)
+    {
+        RENDERER_LOG_WARNING(
+            "Couldn't create texture cache directory %s, textures will not be converted.",
+            cacheDirectory.asChar());
+        return;
+    }
+
+    g_active = true;
+}
+
+void end()
+{
+    if (!g_active)
+        return;
+
+    RENDERER_LOG_DEBUG("Waiting for texture conversions");
+    g_pool->wait();
+    g_queuedFiles.clear();
+    g_active = false;
+}
+
+void cancel()
+{
+    if (!g_active)
+        return;
+
+    RENDERER_LOG_DEBUG("Cancelling texture conversions");
+    g_pool->cancel();
+    g_queuedFiles.clear();
+    g_active = false;
+}
+
+MString defaultCacheDirectory()
+{
+    if (const char* dir = std::getenv("APPLESEED_MAYA_TEXTURE_CACHE"))
+        return MString(dir);
+
+    boost::system::error_code ec;
+    bfs::path p = bfs::temp_directory_path(ec) / "appleseedmaya_textures";
+    return MString(p.string().c_str());
+}
+
+MString convertTexture(const MString& fileName)
+{
+    if (!g_active || fileName.length() == 0)
+        return fileName;
+
+    const bfs::path source(fileName.asChar());
+    if (!isConvertible(source))
+        return fileName;
+
+    boost::system::error_code ec;
+    const boost::uintmax_t fileSize = bfs::file_size(source, ec);
+    if (ec)
+        return fileName;
+
+    const std::time_t lastWriteTime = bfs::last_write_time(source, ec);
+    if (ec)
+        return fileName;
+
+    MurmurHash hash;
+    hash.append(source.string());
+    hash.append(fileSize);
+    hash.append(lastWriteTime);
+    hash.append(CacheVersion);
+
+    const bfs::path destination = g_cacheDirectory / (hash.toString() + ".tx");
+
+    if (!bfs::exists(destination) && g_queuedFiles.count(destination.string()) == 0)
+    {
+        ConversionJob job;
+        job.m_source = source.string();
+        job.m_destination = destination.string();
+        g_pool->push(job);
+
+        g_queuedFiles.insert(job.m_destination);
+    }
+
+    if (!g_referenceDirectory.empty())
+        return MString((g_referenceDirectory / destination.filename()).generic_string().c_str());
+
+    return MString(destination.string().c_str());
+}
+
+} // TextureConverter
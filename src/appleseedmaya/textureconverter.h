@@ -0,0 +1,71 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_MAYA_TEXTURE_CONVERTER_H
+#define APPLESEED_MAYA_TEXTURE_CONVERTER_H
+
+// Maya headers.
+#include <maya/MString.h>
+
+// Forward declarations.
+class MStatus;
+
+//
+// Converts the textures referenced by the scene to tiled and mipmapped
+// .tx files on a pool of background threads. Converted textures are kept
+// in a cache directory, keyed by the source file path, size and time stamp.
+//
+
+namespace TextureConverter
+{
+
+MStatus initialize();
+MStatus uninitialize();
+
+// Start accepting conversions. Converted files are stored in cacheDirectory.
+// If referenceDirectory is not empty, converted file names are returned in it
+// instead of cacheDirectory, e.g. relative to the root of an exported project.
+void begin(const MString& cacheDirectory, const MString& referenceDirectory = MString());
+
+// Wait for all pending conversions and stop accepting new ones.
+void end();
+
+// Drop the pending conversions, wait for the running ones to finish
+// and stop accepting new ones. Used when the export is aborted.
+void cancel();
+
+// Return the default cache directory for non export sessions.
+MString defaultCacheDirectory();
+
+// Queue the conversion of a texture file and return the name of the converted file.
+// Returns fileName if conversions are not active or the file can't be converted.
+MString convertTexture(const MString& fileName);
+
+} // TextureConverter
+
+#endif  // !APPLESEED_MAYA_TEXTURE_CONVERTER_H
@@ -0,0 +1,204 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "appleseedmaya/threadbudget.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
+// Boost headers.
+#include "boost/date_time/posix_time/posix_time_types.hpp"
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+
+// Maya headers.
+#include <maya/MStatus.h>
+
+// appleseed.maya headers.
+#include "appleseedmaya/logger.h"
+
+namespace
+{
+
+boost::mutex                g_mutex;
+boost::condition_variable   g_threadsReleased;
+size_t                      g_totalThreads = 1;
+size_t                      g_highPriorityThreads = 0;
+size_t                      g_lowPriorityThreads = 0;
+size_t                      g_waitingHighPriority = 0;
+
+// Swatches are small, they should yield their threads quickly.
+const long MaxYieldWaitMilliseconds = 2000;
+
+size_t availableThreads()
+{
+    const size_t inUse = g_highPriorityThreads + g_lowPriorityThreads;
+    return g_totalThreads - std::min(inUse, g_totalThreads);
+}
+
+}
+
+namespace ThreadBudget
+{
+
+MStatus initialize()
+{
+    boost::lock_guard<boost::mutex> lock(g_mutex);
+    g_totalThreads = std::max(boost::thread::hardware_concurrency(), 1u);
+    g_highPriorityThreads = 0;
+    g_lowPriorityThreads = 0;
+
+    RENDERER_LOG_DEBUG("Thread budget: %u rendering threads available", static_cast<unsigned int>(g_totalThreads));
+    return MS::kSuccess;
+}
+
+MStatus uninitialize()
+{
+    boost::lock_guard<boost::mutex> lock(g_mutex);
+
+    if (g_highPriorityThreads != 0 || g_lowPriorityThreads != 0)
+        RENDERER_LOG_WARNING("Thread budget: rendering threads still in use at exit");
+
+    return MS::kSuccess;
+}
+
+size_t totalThreads()
+{
+    boost::lock_guard<boost::mutex> lock(g_mutex);
+    return g_totalThreads;
+}
+
+size_t acquire(const Priority priority, const size_t requestedThreads)
+{
+    boost::unique_lock<boost::mutex> lock(g_mutex);
+
+    if (priority == HighPriority)
+    {
+        // Ask the low priority renderers to yield the threads we need.
+        const size_t wantedThreads = requestedThreads == 0 ? g_totalThreads : requestedThreads;
+        const boost::system_time timeout =
+            boost::get_system_time() + boost::posix_time::milliseconds(MaxYieldWaitMilliseconds);
+
+        ++g_waitingHighPriority;
+        while (g_lowPriorityThreads != 0 && availableThreads() < wantedThreads)
+        {
+            if (!g_threadsReleased.timed_wait(lock, timeout))
+            {
+                RENDERER_LOG_WARNING("Thread budget: swatch renders did not release their threads in time");
+                break;
+            }
+        }
+        --g_waitingHighPriority;
+
+        size_t numThreads = std::min(wantedThreads, availableThreads());
+
+        // Other high priority renderers use all the threads;
+        // 0 would mean all the threads to appleseed.
+        if (numThreads == 0)
+        {
+            RENDERER_LOG_WARNING("Thread budget: all the rendering threads are in use, rendering with one thread");
+            numThreads = 1;
+        }
+
+        g_highPriorityThreads += numThreads;
+        return numThreads;
+    }
+
+    // Low priority renderers only use free threads and never delay high priority ones.
+    if (g_waitingHighPriority != 0)
+        return 0;
+
+    const size_t available = availableThreads();
+    const size_t numThreads = requestedThreads == 0 ? available : std::min(requestedThreads, available);
+    g_lowPriorityThreads += numThreads;
+    return numThreads;
+}
+
+void release(const Priority priority, const size_t numThreads)
+{
+    boost::lock_guard<boost::mutex> lock(g_mutex);
+
+    size_t& inUse = priority == HighPriority ? g_highPriorityThreads : g_lowPriorityThreads;
+    assert(inUse >= numThreads);
+    inUse -= std::min(numThreads, inUse);
+
+    g_threadsReleased.notify_all();
+}
+
+bool yieldRequested()
+{
+    boost::lock_guard<boost::mutex> lock(g_mutex);
+    return g_waitingHighPriority != 0;
+}
+
+ScopedReservation::ScopedReservation()
+  : m_priority(LowPriority)
+  , m_numThreads(0)
+{
+}
+
+ScopedReservation::ScopedReservation(const Priority priority, const size_t requestedThreads)
+  : m_priority(priority)
+  , m_numThreads(0)
+{
+    acquire(priority, requestedThreads);
+}
+
+ScopedReservation::~ScopedReservation()
+{
+    release();
+}
+
+size_t ScopedReservation::acquire(const Priority priority, const size_t requestedThreads)
+{
+    release();
+
+    m_priority = priority;
+    m_numThreads = ThreadBudget::acquire(priority, requestedThreads);
+    return m_numThreads;
+}
+
+void ScopedReservation::release()
+{
+    if (m_numThreads != 0)
+    {
+        ThreadBudget::release(m_priority, m_numThreads);
+        m_numThreads = 0;
+    }
+}
+
+size_t ScopedReservation::numThreads() const
+{
+    return m_numThreads;
+}
+
+} // ThreadBudget
@@ -0,0 +1,98 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_MAYA_THREAD_BUDGET_H
+#define APPLESEED_MAYA_THREAD_BUDGET_H
+
+// Standard headers.
+#include <cstddef>
+
+// appleseed.maya headers.
+#include "appleseedmaya/utils.h"
+
+// Forward declarations.
+class MStatus;
+
+//
+// Hands out rendering threads to all the renderers running inside Maya,
+// so that final renders, IPR and swatches don't oversubscribe the machine.
+// High priority renderers (final renders and IPR) get the threads they ask for,
+// waiting for low priority renderers (swatches) to yield theirs if needed;
+// low priority renderers get what is left, possibly nothing.
+//
+
+namespace ThreadBudget
+{
+
+enum Priority
+{
+    HighPriority,
+    LowPriority
+};
+
+MStatus initialize();
+MStatus uninitialize();
+
+// Return the number of threads available for rendering.
+size_t totalThreads();
+
+// Reserve threads for a renderer. A request of 0 threads means all the threads
+// the renderer is allowed to use. Returns the number of threads granted,
+// which is 0 for low priority renderers when no thread is free.
+size_t acquire(const Priority priority, const size_t requestedThreads);
+
+// Return previously granted threads to the budget.
+void release(const Priority priority, const size_t numThreads);
+
+// Return true if a high priority renderer is waiting for threads.
+// Low priority renderers should stop rendering and release their threads.
+bool yieldRequested();
+
+// Keeps a thread reservation while in scope.
+class ScopedReservation
+  : NonCopyable
+{
+  public:
+    ScopedReservation();
+    ScopedReservation(const Priority priority, const size_t requestedThreads);
+
+    ~ScopedReservation();
+
+    size_t acquire(const Priority priority, const size_t requestedThreads);
+    void release();
+
+    size_t numThreads() const;
+
+  private:
+    Priority    m_priority;
+    size_t      m_numThreads;
+};
+
+} // ThreadBudget
+
+#endif  // !APPLESEED_MAYA_THREAD_BUDGET_H
@@ -0,0 +1,161 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "appleseedmaya/transformcache.h"
+
+// Maya headers.
+#include <maya/MDagPath.h>
+#include <maya/MFn.h>
+#include <maya/MFnDagNode.h>
+#include <maya/MObject.h>
+
+namespace asf = foundation;
+
+TransformCache::TransformCache()
+{
+    clear();
+}
+
+void TransformCache::clear()
+{
+    m_entries.clear();
+    m_index.clear();
+
+    // The first entry is the world.
+    Entry world;
+    world.m_world.setToIdentity();
+    world.m_matrix = asf::Matrix4d::identity();
+    world.m_inverse = asf::Matrix4d::identity();
+    world.m_hasMatrix = true;
+    world.m_hasInverse = true;
+    m_entries.push_back(world);
+}
+
+const asf::Matrix4d& TransformCache::worldMatrix(const MDagPath& path)
+{
+    return convertedEntry(path).m_matrix;
+}
+
+asf::Transformd TransformCache::worldTransform(const MDagPath& path)
+{
+    Entry& entry = convertedEntry(path);
+
+    if (!entry.m_hasInverse)
+    {
+        entry.m_inverse = asf::inverse(entry.m_matrix);
+        entry.m_hasInverse = true;
+    }
+
+    return asf::Transformd(entry.m_matrix, entry.m_inverse);
+}
+
+asf::Transformd TransformCache::relativeTransform(const MDagPath& path, const MDagPath& rootPath)
+{
+    const asf::Transformd root = worldTransform(rootPath);
+    const asf::Transformd world = worldTransform(path);
+
+    return asf::Transformd(
+        root.get_parent_to_local() * world.get_local_to_parent(),
+        world.get_parent_to_local() * root.get_local_to_parent());
+}
+
+size_t TransformCache::findEntry(const MDagPath& path)
+{
+    if (path.length() == 0)
+        return 0;
+
+    // Shapes share the world matrix of their transform.
+    MDagPath transformPath(path);
+    if (!transformPath.hasFn(MFn::kTransform))
+    {
+        transformPath.pop();
+        return findEntry(transformPath);
+    }
+
+    MDagPath parentPath(transformPath);
+    parentPath.pop();
+    const size_t parentIndex = findEntry(parentPath);
+
+    MObject node = transformPath.node();
+    MObjectHandle handle(node);
+    const EntryKey key(parentIndex, handle.hashCode());
+
+    std::pair<EntryIndex::const_iterator, EntryIndex::const_iterator> range =
+        m_index.equal_range(key);
+
+    for (EntryIndex::const_iterator it = range.first; it != range.second; ++it)
+    {
+        if (m_entries[it->second].m_node == handle)
+            return it->second;
+    }
+
+    Entry entry;
+    entry.m_node = handle;
+    entry.m_hasMatrix = false;
+    entry.m_hasInverse = false;
+
+    if (transformPath.hasFn(MFn::kJoint))
+    {
+        // Joint orients and scale compensation are not part of the
+        // transformation matrix; let Maya compute the full matrix.
+        entry.m_world = transformPath.inclusiveMatrix();
+    }
+    else
+    {
+        MFnDagNode dagNodeFn(transformPath);
+        entry.m_world = dagNodeFn.transformationMatrix();
+
+        // Maya matrices multiply row vectors: local first, then parent.
+        if (dagNodeFn.inheritsTransform())
+            entry.m_world *= m_entries[parentIndex].m_world;
+    }
+
+    const size_t index = m_entries.size();
+    m_entries.push_back(entry);
+    m_index.insert(std::make_pair(key, index));
+    return index;
+}
+
+TransformCache::Entry& TransformCache::convertedEntry(const MDagPath& path)
+{
+    Entry& entry = m_entries[findEntry(path)];
+
+    if (!entry.m_hasMatrix)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+                entry.m_matrix(i, j) = entry.m_world[j][i];
+        }
+
+        entry.m_hasMatrix = true;
+    }
+
+    return entry;
+}
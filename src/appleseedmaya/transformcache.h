@@ -0,0 +1,100 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_MAYA_TRANSFORM_CACHE_H
+#define APPLESEED_MAYA_TRANSFORM_CACHE_H
+
+// Standard headers.
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Maya headers.
+#include <maya/MMatrix.h>
+#include <maya/MObjectHandle.h>
+
+// appleseed.foundation headers.
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+
+// appleseed.maya headers.
+#include "appleseedmaya/utils.h"
+
+// Forward declarations.
+class MDagPath;
+
+//
+// World transforms of the dag nodes at the current time.
+//
+//  Each transform node reached by a dag path is computed once, by combining
+//  its local matrix with the world matrix of its parent. Inverses are only
+//  computed when asked for. Must be cleared every time the current time changes.
+//
+
+class TransformCache
+  : NonCopyable
+{
+  public:
+    TransformCache();
+
+    // Forget all cached transforms.
+    void clear();
+
+    // Return the world matrix of the dag path, converted to appleseed conventions.
+    const foundation::Matrix4d& worldMatrix(const MDagPath& path);
+
+    // Return the world transform of the dag path, including its inverse.
+    foundation::Transformd worldTransform(const MDagPath& path);
+
+    // Return the transform of the dag path relative to one of its parents.
+    foundation::Transformd relativeTransform(const MDagPath& path, const MDagPath& rootPath);
+
+  private:
+    struct Entry
+    {
+        MObjectHandle           m_node;
+        MMatrix                 m_world;
+        foundation::Matrix4d    m_matrix;
+        foundation::Matrix4d    m_inverse;
+        bool                    m_hasMatrix;
+        bool                    m_hasInverse;
+    };
+
+    // Entries are indexed by the parent entry and the hash code of the node.
+    typedef std::pair<size_t, unsigned int> EntryKey;
+    typedef std::multimap<EntryKey, size_t> EntryIndex;
+
+    size_t findEntry(const MDagPath& path);
+    Entry& convertedEntry(const MDagPath& path);
+
+    std::vector<Entry>  m_entries;
+    EntryIndex          m_index;
+};
+
+#endif  // !APPLESEED_MAYA_TRANSFORM_CACHE_H
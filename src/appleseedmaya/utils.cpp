@@ -40,7 +40,9 @@
 // Maya headers.
 #include <maya/MDagPath.h>
 #include <maya/MEventMessage.h>
+#include <maya/MGlobal.h>
 #include <maya/MObject.h>
+#include <maya/MProgressWindow.h>
 #include <maya/MSelectionList.h>
 
 // appleseed.maya headers.
@@ -68,28 +70,146 @@ MStatus getDagPathByName(const MString& name, MDagPath& dag)
     return selList.getDagPath(0, dag);
 }
 
+namespace
+{
+
+// Maximum time between two interrupt checks, in seconds.
+const double PollInterval = 0.1;
+
+// Number of checkpoints between two reads of the clock.
+const size_t CheckpointsPerClockRead = 256;
+
+Computation* g_activeComputation = 0;
+
+} // unnamed.
+
 boost::shared_ptr<Computation> Computation::create()
 {
     return boost::shared_ptr<Computation>(new Computation());
 }
 
 Computation::Computation()
+  : m_numCheckpoints(0)
+  , m_progressWindow(false)
+  , m_maxProgress(0)
+  , m_progress(0)
+  , m_interruptRequested(false)
 {
     m_computation.beginComputation();
+    m_pollStopwatch.start();
+    g_activeComputation = this;
 }
 
 Computation::~Computation()
 {
+    endProgress();
     m_computation.endComputation();
+
+    if (g_activeComputation == this)
+        g_activeComputation = 0;
 }
 
 bool Computation::isInterruptRequested()
 {
-    return m_computation.isInterruptRequested();
+    if (!m_interruptRequested)
+    {
+        m_interruptRequested = m_computation.isInterruptRequested();
+
+        if (m_progressWindow && MProgressWindow::isCancelled())
+            m_interruptRequested = true;
+    }
+
+    return m_interruptRequested;
 }
 
 void Computation::thowIfInterruptRequested()
 {
-    if (m_computation.isInterruptRequested())
+    if (isInterruptRequested())
         throw AbortRequested();
 }
+
+void Computation::beginProgress(const MString& status, const int maxProgress)
+{
+    m_progressStatus = status;
+    m_maxProgress = std::max(maxProgress, 1);
+    m_progress = 0;
+    m_progressStopwatch.start();
+
+    if (MGlobal::mayaState() != MGlobal::kInteractive)
+        return;
+
+    if (!m_progressWindow)
+    {
+        if (!MProgressWindow::reserve())
+            return;
+
+        m_progressWindow = true;
+        MProgressWindow::setTitle("appleseed");
+        MProgressWindow::setInterruptable(true);
+        MProgressWindow::setProgressRange(0, m_maxProgress);
+        MProgressWindow::setProgressStatus(m_progressStatus);
+        MProgressWindow::setProgress(0);
+        MProgressWindow::startProgress();
+    }
+    else
+    {
+        MProgressWindow::setProgressRange(0, m_maxProgress);
+        MProgressWindow::setProgressStatus(m_progressStatus);
+        MProgressWindow::setProgress(0);
+    }
+}
+
+void Computation::advanceProgress(const int amount)
+{
+    m_progress = std::min(m_progress + amount, m_maxProgress);
+    poll();
+}
+
+void Computation::endProgress()
+{
+    if (m_progressWindow)
+    {
+        MProgressWindow::endProgress();
+        m_progressWindow = false;
+    }
+}
+
+void Computation::checkpoint()
+{
+    if (g_activeComputation == 0)
+        return;
+
+    if (++g_activeComputation->m_numCheckpoints % CheckpointsPerClockRead == 0)
+        g_activeComputation->poll();
+}
+
+void Computation::poll()
+{
+    m_pollStopwatch.measure();
+    if (m_pollStopwatch.get_seconds() < PollInterval)
+        return;
+
+    m_pollStopwatch.start();
+
+    if (m_progressWindow)
+    {
+        MString status = m_progressStatus;
+
+        // Estimate the remaining time from the progress so far.
+        if (m_progress > 0)
+        {
+            m_progressStopwatch.measure();
+            const double elapsed = m_progressStopwatch.get_seconds();
+            const double remaining = elapsed * (m_maxProgress - m_progress) / m_progress;
+
+            status += " (";
+            status += static_cast<int>(remaining + 0.5);
+            status += "s remaining)";
+        }
+
+        MProgressWindow::setProgressStatus(status);
+        MProgressWindow::setProgress(m_progress);
+    }
+
+    thowIfInterruptRequested();
+}
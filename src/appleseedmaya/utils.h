@@ -36,13 +36,16 @@
 // Boost headers.
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 
 // Maya headers.
 #include <maya/MComputation.h>
 #include <maya/MString.h>
 
 // appleseed.foundation headers.
+#include "foundation/platform/timers.h"
 #include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
 // Forward declarations.
@@ -169,34 +172,68 @@ class AppleseedEntityPtr
     bool    m_releaseObj;
 };
 
+//
+// UniqueNameAllocator.
+//
+//  Allocates unique entity names, remembering the next free numeric
+//  suffix of each base name so that colliding names are found in
+//  constant time instead of probing name_2, name_3, ... every time.
+//
+
+class UniqueNameAllocator
+  : NonCopyable
+{
+  public:
+    // Return name if it is not used in the container, otherwise name_N.
+    template<class Container>
+    std::string uniqueName(const Container& container, const std::string& name)
+    {
+        if (container.get_by_name(name.c_str()) == 0)
+            return name;
+
+        size_t& suffix = m_nextSuffix.insert(std::make_pair(name, size_t(2))).first->second;
+
+        // Entities not named by the allocator can still use some suffixes.
+        std::string newName;
+        do
+        {
+            newName = name + "_" + foundation::to_string(suffix++);
+        } while (container.get_by_name(newName.c_str()) != 0);
+
+        return newName;
+    }
+
+  private:
+    boost::unordered_map<std::string, size_t> m_nextSuffix;
+};
+
 // Insert an appleseed entity into a container with an unique name.
 template<class Container, class T>
 void insertEntityWithUniqueName(
     Container&              container,
-    AppleseedEntityPtr<T>&  entity)
+    AppleseedEntityPtr<T>&  entity,
+    UniqueNameAllocator&    nameAllocator)
 {
-    std::string name = entity->get_name();
-
-    if (container.get_by_name(name.c_str()) == 0)
-    {
-        container.insert(entity.release());
-        return;
-    }
+    const std::string name = nameAllocator.uniqueName(container, entity->get_name());
 
-    std::string pattern = name + "_#";
-    size_t i = 2;
+    if (name != entity->get_name())
+        entity->set_name(name.c_str());
 
-    while (true)
-    {
-        std::string new_name = foundation::get_numbered_string(pattern, i++);
+    container.insert(entity.release());
+}
 
-        if (container.get_by_name(new_name.c_str()) == 0)
-        {
-            entity->set_name(new_name.c_str());
-            container.insert(entity.release());
-            break;
-        }
-    }
+// Insert an entity shared by several exporters into a container.
+// Shared entities are named after their contents; if the container
+// already has an entity with the same name, the new one is discarded.
+template<class Container, class T>
+void insertSharedEntity(
+    Container&              container,
+    AppleseedEntityPtr<T>&  entity)
+{
+    if (container.get_by_name(entity->get_name()) == 0)
+        container.insert(entity.release());
+    else
+        entity.reset();
 }
 
 // Get Maya dependency nodes and dag paths by name.
@@ -206,6 +243,11 @@ MStatus getDagPathByName(const MString& name, MDagPath& dag);
 //
 // Simple wrapper around MComputation
 //
+// Long export loops call Computation::checkpoint() for each element.
+// Maya is polled for interrupts at most every pollInterval seconds,
+// which keeps the checks cheap and bounds the time to abort.
+// The same checkpoints feed the progress window, if any.
+//
 
 class Computation
   : public NonCopyable
@@ -220,10 +262,28 @@ class Computation
 
     void thowIfInterruptRequested();
 
+    // Show a progress window while exporting (interactive sessions only).
+    void beginProgress(const MString& status, const int maxProgress);
+    void advanceProgress(const int amount = 1);
+    void endProgress();
+
+    // Throw AbortRequested if the user interrupted the active computation.
+    static void checkpoint();
+
   private:
     Computation();
 
-    MComputation m_computation;
+    void poll();
+
+    MComputation                                        m_computation;
+    size_t                                              m_numCheckpoints;
+    foundation::Stopwatch<foundation::DefaultWallclockTimer>    m_pollStopwatch;
+    foundation::Stopwatch<foundation::DefaultWallclockTimer>    m_progressStopwatch;
+    bool                                                m_progressWindow;
+    MString                                             m_progressStatus;
+    int                                                 m_maxProgress;
+    int                                                 m_progress;
+    bool                                                m_interruptRequested;
 };
 
 typedef boost::shared_ptr<Computation> ComputationPtr;
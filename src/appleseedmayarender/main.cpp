@@ -0,0 +1,379 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2016-2017 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//
+// appleseedMayaRender renders an appleseed project written by the Maya
+// plugin and streams the rendered tiles on its standard output, so that
+// final renders can run outside of the Maya process.
+//
+// Usage: appleseedMayaRender [--threads n] [--schema file] project.appleseed
+//
+
+// Standard headers.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Boost headers.
+#include "boost/cstdint.hpp"
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/log.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/frame.h"
+#include "renderer/api/log.h"
+#include "renderer/api/project.h"
+#include "renderer/api/rendering.h"
+
+// appleseed.maya headers.
+#include "appleseedmaya/renderprocessprotocol.h"
+
+namespace bfs = boost::filesystem;
+namespace asf = foundation;
+namespace asr = renderer;
+
+using namespace RenderProcessProtocol;
+
+namespace
+{
+
+//
+// Serializes the messages sent to the Maya plugin.
+//
+
+class MessageWriter
+{
+  public:
+    void frameBegin(const asr::Frame& frame)
+    {
+        const asf::CanvasProperties& props = frame.image().properties();
+        const boost::uint32_t payload[4] =
+        {
+            static_cast<boost::uint32_t>(props.m_canvas_width),
+            static_cast<boost::uint32_t>(props.m_canvas_height),
+            static_cast<boost::uint32_t>(props.m_tile_width),
+            static_cast<boost::uint32_t>(props.m_tile_height)
+        };
+
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        write(FrameBeginMessage, payload, sizeof(payload));
+        std::fflush(stdout);
+    }
+
+    void tileHighlight(
+        const size_t        x,
+        const size_t        y,
+        const size_t        width,
+        const size_t        height)
+    {
+        const boost::uint32_t payload[4] =
+        {
+            static_cast<boost::uint32_t>(x),
+            static_cast<boost::uint32_t>(y),
+            static_cast<boost::uint32_t>(width),
+            static_cast<boost::uint32_t>(height)
+        };
+
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        write(TileHighlightMessage, payload, sizeof(payload));
+        std::fflush(stdout);
+    }
+
+    void tile(
+        const asr::Frame&   frame,
+        const size_t        tileX,
+        const size_t        tileY)
+    {
+        const asf::Tile& tile = frame.image().tile(tileX, tileY);
+        const size_t width = tile.get_width();
+        const size_t height = tile.get_height();
+
+        const boost::uint32_t payload[4] =
+        {
+            static_cast<boost::uint32_t>(tileX),
+            static_cast<boost::uint32_t>(tileY),
+            static_cast<boost::uint32_t>(width),
+            static_cast<boost::uint32_t>(height)
+        };
+
+        std::vector<float> pixels(width * height * 4);
+        float* p = &pixels[0];
+
+        for (size_t y = 0; y < height; ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                for (size_t c = 0; c < 4; ++c)
+                    *p++ = tile.get_component<float>(x, y, c);
+            }
+        }
+
+        MessageHeader header;
+        header.m_type = TileMessage;
+        header.m_size = static_cast<boost::uint32_t>(sizeof(payload) + pixels.size() * sizeof(float));
+
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        std::fwrite(&header, sizeof(header), 1, stdout);
+        std::fwrite(payload, sizeof(payload), 1, stdout);
+        std::fwrite(&pixels[0], sizeof(float), pixels.size(), stdout);
+        std::fflush(stdout);
+    }
+
+    void frameUpdated()
+    {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        write(FrameUpdatedMessage, 0, 0);
+        std::fflush(stdout);
+    }
+
+    void frameEnd(const bool completed)
+    {
+        const boost::uint32_t payload[1] = { completed ? 0u : 1u };
+
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        write(FrameEndMessage, payload, sizeof(payload));
+        std::fflush(stdout);
+    }
+
+  private:
+    void write(const MessageType type, const void* payload, const size_t size)
+    {
+        MessageHeader header;
+        header.m_type = type;
+        header.m_size = static_cast<boost::uint32_t>(size);
+        std::fwrite(&header, sizeof(header), 1, stdout);
+
+        if (size != 0)
+            std::fwrite(payload, size, 1, stdout);
+    }
+
+    boost::mutex m_mutex;
+};
+
+class StreamTileCallback
+  : public asr::ITileCallback
+{
+  public:
+    explicit StreamTileCallback(MessageWriter& writer)
+      : m_writer(writer)
+    {
+    }
+
+    virtual void release()
+    {
+        delete this;
+    }
+
+    virtual void pre_render(
+        const size_t        x,
+        const size_t        y,
+        const size_t        width,
+        const size_t        height)
+    {
+        m_writer.tileHighlight(x, y, width, height);
+    }
+
+    virtual void post_render_tile(
+        const asr::Frame*   frame,
+        const size_t        tile_x,
+        const size_t        tile_y)
+    {
+        m_writer.tile(*frame, tile_x, tile_y);
+    }
+
+    virtual void post_render(
+        const asr::Frame*   frame)
+    {
+        const asf::CanvasProperties& props = frame->image().properties();
+
+        for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+            for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
+                m_writer.tile(*frame, tx, ty);
+
+        m_writer.frameUpdated();
+    }
+
+  private:
+    MessageWriter& m_writer;
+};
+
+class StreamTileCallbackFactory
+  : public asr::ITileCallbackFactory
+{
+  public:
+    explicit StreamTileCallbackFactory(MessageWriter& writer)
+      : m_writer(writer)
+    {
+    }
+
+    virtual void release()
+    {
+        delete this;
+    }
+
+    virtual asr::ITileCallback* create()
+    {
+        return new StreamTileCallback(m_writer);
+    }
+
+  private:
+    MessageWriter& m_writer;
+};
+
+//
+// Stops the render when the Maya plugin sends TerminateCommand
+// on the standard input, and aborts it when the input is closed.
+//
+
+class StdinRendererController
+  : public asr::DefaultRendererController
+{
+  public:
+    StdinRendererController()
+      : m_status(ContinueRendering)
+    {
+        boost::thread thread(&StdinRendererController::watchStdin, this);
+        thread.detach();
+    }
+
+    virtual Status get_status() const
+    {
+        return m_status;
+    }
+
+  private:
+    void watchStdin()
+    {
+        int c;
+        while ((c = std::fgetc(stdin)) != EOF)
+        {
+            if (c == TerminateCommand)
+                m_status = TerminateRendering;
+        }
+
+        m_status = AbortRendering;
+    }
+
+    volatile Status m_status;
+};
+
+void printUsage()
+{
+    std::fprintf(stderr, "Usage: appleseedMayaRender [--threads n] [--schema file] project.appleseed\n");
+}
+
+} // unnamed.
+
+int main(int argc, char* argv[])
+{
+    std::string projectFileName;
+    std::string schemaFileName;
+    int numThreads = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            numThreads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--schema") == 0 && i + 1 < argc)
+            schemaFileName = argv[++i];
+        else
+            projectFileName = argv[i];
+    }
+
+    if (projectFileName.empty())
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    // By default, look for the project schema in the deployed plugin layout.
+    if (schemaFileName.empty())
+    {
+        const bfs::path exePath = bfs::system_complete(bfs::path(argv[0]));
+        schemaFileName = (exePath.parent_path().parent_path() / "schemas" / "project.xsd").string();
+    }
+
+#ifdef _WIN32
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    // Log to stderr; stdout is reserved for the tiles.
+    asf::auto_release_ptr<asf::ILogTarget> logTarget(asf::create_console_log_target(stderr));
+    asr::global_logger().add_target(logTarget.get());
+
+    asr::ProjectFileReader reader;
+    asf::auto_release_ptr<asr::Project> project(
+        reader.read(projectFileName.c_str(), schemaFileName.c_str()));
+
+    if (project.get() == 0)
+    {
+        asr::global_logger().remove_target(logTarget.get());
+        return EXIT_FAILURE;
+    }
+
+    asr::ParamArray params =
+        project->configurations().get_by_name("final")->get_inherited_parameters();
+
+    if (numThreads > 0)
+        params.insert("rendering_threads", numThreads);
+
+    MessageWriter writer;
+    StdinRendererController rendererController;
+    StreamTileCallbackFactory tileCallbackFactory(writer);
+
+    asr::MasterRenderer renderer(
+        *project,
+        params,
+        &rendererController,
+        &tileCallbackFactory);
+
+    writer.frameBegin(*project->get_frame());
+    const bool completed =
+        renderer.render() && rendererController.get_status() != asr::IRendererController::AbortRendering;
+    writer.frameEnd(completed);
+
+    asr::global_logger().remove_target(logTarget.get());
+    return completed ? EXIT_SUCCESS : EXIT_FAILURE;
+}